@@ -0,0 +1,378 @@
+// calendar.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "config.h"
+#include "lifecycle.h"
+#include "timing.h"
+#include "calendar.h"
+#include "replay.h"
+
+/*
+ * reservation calendar for runways and gates. every unit has a slot array of
+ * RESERVATION_SLOT seconds; a slot holds the booking (plane * N_PHASES + phase)
+ * that owns it, or FREE. when a plane starts, its whole lifecycle is booked with
+ * the longest service time of every phase, so it usually arrives early. a plane
+ * that shows up more than RESERVATION_TOLERANCE late, or never shows up, loses
+ * its slots and the rest of its lifecycle is booked again from that moment; one
+ * that shows up early books it again too, to hand back the slots it no longer needs.
+ *
+ * a unit can be taken when it is not in use and nobody else holds a live booking
+ * for it over the time the phase needs.
+ *
+ * every use of a unit is recorded with the booking it had, and the report replays
+ * that demand in virtual time with and without the bookings, so the difference
+ * comes from the reservations alone and not from how the units are handed out.
+ */
+
+#define FREE (-1)
+
+typedef struct {
+    int     unit[N_RESOURCE_TYPES];     // booked unit, -1 if none
+    bool    claimed[N_RESOURCE_TYPES];  // the plane took the booked unit
+    int     first;                      // slots [first, last)
+    int     last;
+    int     made;                       // slot the booking was made in
+} Booking;
+
+static pthread_mutex_t  mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   released = PTHREAD_COND_INITIALIZER;
+static struct timespec  opened_at;
+static int              capacity[N_RESOURCE_TYPES];
+static int              n_slots;
+static int             *slots[N_RESOURCE_TYPES];    // [unit * n_slots + slot]
+static bool            *in_use[N_RESOURCE_TYPES];
+static Booking         *bookings;                   // [plane * N_PHASES + phase]
+static FlightType      *types;
+static long             n_bookings;                 // phases booked when planes start
+static long             n_rescheduled;              // late check-ins booked again
+static long             n_moved_up;                 // early check-ins booked again
+static long             outcomes[N_RESOURCE_TYPES][2];  // [resource][honored]
+static Use             *current[N_RESOURCE_TYPES];      // [unit]
+static Use             *trace[N_RESOURCE_TYPES];
+static int              trace_length[N_RESOURCE_TYPES];
+static int              trace_capacity;
+
+static int
+slots_for(double seconds)
+{
+    return (int)ceil(seconds / RESERVATION_SLOT);
+}
+
+static int
+phase_slots(const Phase *phase)
+{
+    return slots_for((phase->max_usec + phase->hold_usec) / 1e6);
+}
+
+static bool
+uses_calendar(const PhaseClass *class)
+{
+    for (int i = 0; i < class->n_resources; i++) {
+        if (calendar_books(class->order[i])) return true;
+    }
+    return false;
+}
+
+static void
+cancel(int code, ResourceType resource)
+{
+    Booking *booking = &bookings[code];
+    if (booking->unit[resource] < 0) return;
+
+    int *row = slots[resource] + booking->unit[resource] * n_slots;
+    for (int s = booking->first; s < booking->last && s < n_slots; s++) {
+        if (row[s] == code) row[s] = FREE;
+    }
+    booking->unit[resource] = -1;
+    booking->claimed[resource] = false;
+}
+
+// a booking nobody showed up for within the tolerance is given back
+static bool
+live(int code, ResourceType resource, int now_slot)
+{
+    Booking *booking = &bookings[code];
+    if (booking->unit[resource] < 0) return false;
+    if (!booking->claimed[resource] && now_slot > booking->first + slots_for(RESERVATION_TOLERANCE)) {
+        cancel(code, resource);
+        return false;
+    }
+    return true;
+}
+
+static bool
+unit_free(ResourceType resource, int unit, int first, int last, int plane_id, int now_slot)
+{
+    const int *row = slots[resource] + unit * n_slots;
+    if (last > n_slots) last = n_slots;
+    for (int s = (first > 0) ? first : 0; s < last; s++) {
+        int code = row[s];
+        if (code != FREE && code / N_PHASES != plane_id && live(code, resource, now_slot)) return false;
+    }
+    return true;
+}
+
+// books the earliest start from 'from' with a free unit of every calendar resource of the phase
+static int
+book(int plane_id, int p, int from, int now_slot)
+{
+    const PhaseClass *class = &PHASES[p].classes[types[plane_id]];
+    int code = plane_id * N_PHASES + p;
+    int length = phase_slots(&PHASES[p]);
+    int found[N_RESOURCE_TYPES];
+
+    for (int start = from; start + length <= n_slots; start++) {
+        bool ok = true;
+        for (int i = 0; i < class->n_resources && ok; i++) {
+            ResourceType r = class->order[i];
+            if (!calendar_books(r)) continue;
+            found[r] = -1;
+            for (int u = 0; u < capacity[r] && found[r] < 0; u++) {
+                if (unit_free(r, u, start, start + length, plane_id, now_slot)) found[r] = u;
+            }
+            ok = (found[r] >= 0);
+        }
+        if (!ok) continue;
+
+        Booking *booking = &bookings[code];
+        booking->first = start;
+        booking->last = start + length;
+        booking->made = now_slot;
+        for (int i = 0; i < class->n_resources; i++) {
+            ResourceType r = class->order[i];
+            if (!calendar_books(r)) continue;
+            booking->unit[r] = found[r];
+            booking->claimed[r] = false;
+            for (int s = start; s < start + length; s++) {
+                slots[r][found[r] * n_slots + s] = code;
+            }
+        }
+        return start + length;
+    }
+    return -1;
+}
+
+// books phases from 'from_phase' on, one after the other, starting at slot 'cursor';
+// returns how many phases got a booking
+static int
+plan(int plane_id, int from_phase, int cursor, int now_slot)
+{
+    int booked = 0;
+    for (int p = from_phase; p < N_PHASES; p++) {
+        const Phase *phase = &PHASES[p];
+        if (!phase_enabled(phase, capacity)) continue;
+
+        int end = -1;
+        if (uses_calendar(&phase->classes[types[plane_id]])) {
+            end = book(plane_id, p, cursor, now_slot);
+        }
+        cursor = (end >= 0) ? end : cursor + phase_slots(phase);
+        booked += (end >= 0);
+    }
+    return booked;
+}
+
+void
+calendar_open(const int resource_capacity[N_RESOURCE_TYPES], int max_planes)
+{
+    clock_gettime(CLOCK_MONOTONIC, &opened_at);
+    n_slots = slots_for(SIM_DURATION + 2 * TIME_TILL_CRASH);
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        capacity[r] = resource_capacity[r];
+        if (!calendar_books(r)) continue;
+        slots[r] = malloc((capacity[r] > 0 ? capacity[r] : 1) * n_slots * sizeof(int));
+        for (int s = 0; s < capacity[r] * n_slots; s++) slots[r][s] = FREE;
+        in_use[r] = calloc(capacity[r] > 0 ? capacity[r] : 1, sizeof(bool));
+        current[r] = calloc(capacity[r] > 0 ? capacity[r] : 1, sizeof(Use));
+        trace[r] = malloc(max_planes * N_PHASES * sizeof(Use));
+        trace_length[r] = 0;
+    }
+    trace_capacity = max_planes * N_PHASES;
+    bookings = malloc(max_planes * N_PHASES * sizeof(Booking));
+    for (int i = 0; i < max_planes * N_PHASES; i++) {
+        for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+            bookings[i].unit[r] = -1;
+            bookings[i].claimed[r] = false;
+        }
+    }
+    types = calloc(max_planes, sizeof(FlightType));
+}
+
+void
+calendar_close(void)
+{
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        free(slots[r]);
+        free(in_use[r]);
+        free(current[r]);
+        free(trace[r]);
+    }
+    free(bookings);
+    free(types);
+}
+
+void
+calendar_book(int plane_id, FlightType type)
+{
+    pthread_mutex_lock(&mutex);
+    int now_slot = (int)(seconds_since(&opened_at) / RESERVATION_SLOT);
+    types[plane_id] = type;
+    n_bookings += plan(plane_id, 0, now_slot, now_slot);
+    pthread_mutex_unlock(&mutex);
+}
+
+void
+calendar_checkin(int plane_id, int phase)
+{
+    if (!uses_calendar(&PHASES[phase].classes[types[plane_id]])) return;
+
+    pthread_mutex_lock(&mutex);
+    int now_slot = (int)(seconds_since(&opened_at) / RESERVATION_SLOT);
+    int code = plane_id * N_PHASES + phase;
+    bool booked = false;
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        if (calendar_books(r) && live(code, r, now_slot)) booked = true;
+    }
+
+    // late or unbooked, book the rest of the lifecycle again from now; early, move it up
+    bool late = !booked || now_slot > bookings[code].first + slots_for(RESERVATION_TOLERANCE);
+    if (late || now_slot < bookings[code].first) {
+        for (int p = phase; p < N_PHASES; p++) {
+            for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+                if (calendar_books(r)) cancel(plane_id * N_PHASES + p, r);
+            }
+        }
+        plan(plane_id, phase, now_slot, now_slot);
+        if (late) n_rescheduled++;
+        else n_moved_up++;
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+int
+calendar_booked(int plane_id, int phase, ResourceType resource)
+{
+    pthread_mutex_lock(&mutex);
+    int code = plane_id * N_PHASES + phase;
+    int unit = live(code, resource, (int)(seconds_since(&opened_at) / RESERVATION_SLOT)) ? bookings[code].unit[resource] : -1;
+    pthread_mutex_unlock(&mutex);
+    return unit;
+}
+
+bool
+calendar_allows(ResourceType resource, int unit, int plane_id, double seconds)
+{
+    pthread_mutex_lock(&mutex);
+    int now_slot = (int)(seconds_since(&opened_at) / RESERVATION_SLOT);
+    bool allowed = unit_free(resource, unit, now_slot, now_slot + slots_for(seconds), plane_id, now_slot);
+    pthread_mutex_unlock(&mutex);
+    return allowed;
+}
+
+int
+calendar_acquire(int plane_id, int phase, ResourceType resource)
+{
+    int code = plane_id * N_PHASES + phase;
+    int length = phase_slots(&PHASES[phase]);
+
+    pthread_mutex_lock(&mutex);
+    for (;;) {
+        int now_slot = (int)(seconds_since(&opened_at) / RESERVATION_SLOT);
+        int unit = -1;
+
+        if (live(code, resource, now_slot)) {
+            int booked = bookings[code].unit[resource];
+            if (!in_use[resource][booked] && unit_free(resource, booked, now_slot, now_slot + length, plane_id, now_slot)) {
+                unit = booked;
+            }
+        }
+        for (int u = 0; u < capacity[resource] && unit < 0; u++) {
+            if (!in_use[resource][u] && unit_free(resource, u, now_slot, now_slot + length, plane_id, now_slot)) unit = u;
+        }
+        if (unit >= 0) {
+            in_use[resource][unit] = true;
+            pthread_mutex_unlock(&mutex);
+            return unit;
+        }
+
+        // a unit blocked by a booking its owner never claims opens up after the tolerance
+        timed_wait_ms(&released, &mutex, 100);
+    }
+}
+
+void
+calendar_observe(int plane_id, int phase, ResourceType resource, int unit, double waited)
+{
+    int code = plane_id * N_PHASES + phase;
+
+    pthread_mutex_lock(&mutex);
+    int booked_unit = bookings[code].unit[resource];
+    int booked_from = bookings[code].first, booked_until = bookings[code].last, booked_at = bookings[code].made;
+    bool honored = (booked_unit >= 0 && booked_unit == unit);
+    if (honored) {
+        bookings[code].claimed[resource] = true;
+    } else {
+        cancel(code, resource);
+    }
+    outcomes[resource][honored]++;
+
+    double t = seconds_since(&opened_at);
+    current[resource][unit] = (Use){
+        .plane_id = plane_id, .phase = phase, .type = types[plane_id], .operation = PHASES[phase].runway,
+        .requested_at = t - waited, .start_at = t, .unit = unit, .booked_unit = booked_unit,
+        .booked_at = booked_at * RESERVATION_SLOT,
+        .booked_from = booked_from * RESERVATION_SLOT, .booked_until = booked_until * RESERVATION_SLOT,
+    };
+    pthread_mutex_unlock(&mutex);
+}
+
+void
+calendar_release(int plane_id, ResourceType resource, int unit)
+{
+    pthread_mutex_lock(&mutex);
+    if (unit >= 0) {
+        Use *use = &current[resource][unit];
+        use->duration = seconds_since(&opened_at) - use->start_at;
+        if (trace_length[resource] < trace_capacity) trace[resource][trace_length[resource]++] = *use;
+        in_use[resource][unit] = false;
+    }
+    for (int p = 0; p < N_PHASES; p++) {
+        int code = plane_id * N_PHASES + p;
+        if (bookings[code].claimed[resource] && bookings[code].unit[resource] == unit) cancel(code, resource);
+    }
+    pthread_cond_broadcast(&released);
+    pthread_mutex_unlock(&mutex);
+}
+
+void
+calendar_print_report(void)
+{
+    pthread_mutex_lock(&mutex);
+    long honored = outcomes[RESOURCE_TRACK][1] + outcomes[RESOURCE_GATE][1];
+    long total = honored + outcomes[RESOURCE_TRACK][0] + outcomes[RESOURCE_GATE][0];
+
+    printf("\n--> RESERVAS:\n");
+    printf("  fases reservadas na partida: %ld\n", n_bookings);
+    printf("  reagendamentos por atraso: %ld, antecipações: %ld\n", n_rescheduled, n_moved_up);
+    printf("  taxa de acerto: %.2f%% (%ld de %ld)\n",
+           (total > 0) ? (double)honored / total * 100 : 0.0, honored, total);
+    printf("  mesma demanda reproduzida:\n");
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        if (!calendar_books(r) || capacity[r] == 0) continue;
+
+        // runways are handed out as the sequencer does, gates first-come-first-served
+        bool sequenced = SEQUENCER_ENABLED && r == RESOURCE_TRACK;
+        Throughput measured = measure_uses(trace[r], trace_length[r]);
+        Throughput unreserved = replay_uses(trace[r], trace_length[r], capacity[r], sequenced, sequenced, false);
+        Throughput reserved = replay_uses(trace[r], trace_length[r], capacity[r], sequenced, sequenced, true);
+        printf("    espera média por %s: %.2fs sem reservas, %.2fs com, %+.2fs (medida: %.2fs, %d usos)\n",
+               RESOURCES[r].name, unreserved.average_wait, reserved.average_wait,
+               reserved.average_wait - unreserved.average_wait, measured.average_wait, trace_length[r]);
+    }
+    pthread_mutex_unlock(&mutex);
+}
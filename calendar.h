@@ -0,0 +1,36 @@
+// calendar.h
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+#include <stdbool.h>
+
+#include "lifecycle.h"
+
+// resources the calendar hands out unit by unit
+static inline bool
+calendar_books(ResourceType resource)
+{
+    return resource == RESOURCE_TRACK || resource == RESOURCE_GATE;
+}
+
+void calendar_open(const int capacity[N_RESOURCE_TYPES], int max_planes);
+void calendar_close(void);
+
+// books runway and gate slots for the whole lifecycle of a plane, from now on
+void calendar_book(int plane_id, FlightType type);
+// called when a plane starts a phase; rebooks the rest of its lifecycle if it is late
+void calendar_checkin(int plane_id, int phase);
+
+// the unit booked for a phase, -1 if the booking lapsed or there is none
+int calendar_booked(int plane_id, int phase, ResourceType resource);
+// false if another plane booked the unit for the next 'seconds'
+bool calendar_allows(ResourceType resource, int unit, int plane_id, double seconds);
+// blocks until a unit the plane may use is free; prefers the booked one
+int calendar_acquire(int plane_id, int phase, ResourceType resource);
+// records whether the unit taken honored the booking and how long the plane waited
+void calendar_observe(int plane_id, int phase, ResourceType resource, int unit, double waited);
+void calendar_release(int plane_id, ResourceType resource, int unit);
+
+void calendar_print_report(void);
+
+#endif /* CALENDAR_H */
@@ -0,0 +1,636 @@
+// capacity.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "config.h"
+#include "params.h"
+#include "lifecycle.h"
+#include "rng.h"
+#include "timing.h"
+#include "capacity.h"
+#include "sequencer.h"
+
+/*
+ * the search evaluates every candidate with a discrete-event model of the PHASES[]
+ * lifecycle instead of running the threaded simulation: time is simulated and each
+ * run is seeded, so a one hour run takes well under a millisecond and every
+ * configuration sees the same arrivals.
+ *
+ * like the simulator, a phase takes its resources one at a time in its class order
+ * and holds what it has while it waits for the rest, so classes with different
+ * orders can deadlock. a plane stuck past TIME_TILL_DEADLOCK (or TIME_TILL_CRASH)
+ * gives back what it holds and counts as a crash.
+ *
+ * with SEQUENCER_ENABLED, tracks are runways with separations, as in the simulation:
+ * a phase that needs one waits for an idle runway, and starts once the separation
+ * after that runway's last operation has passed. the model serves runways in
+ * request order, it does not reorder them the way the sequencer does.
+ */
+
+// event kinds
+typedef enum {
+    EVENT_ARRIVAL,
+    EVENT_PHASE_END,
+    EVENT_HOLD_RELEASE,
+    EVENT_TIMEOUT
+} EventKind;
+
+// scheduled event
+typedef struct {
+    double      at;
+    uint64_t    seq;        // tie-break so runs are reproducible
+    EventKind   kind;
+    int         plane;
+    int         phase;
+} Event;
+
+// simulated plane
+typedef struct {
+    FlightType  type;
+    bool        priority_cleared;   // went through the international priority check
+    bool        waiting;
+    int         phase;
+    int         acquired;           // resources of the class taken so far, in order
+    int         runway;
+    double      runway_ready;       // the separation on the taken runway has passed
+    double      requested_at;
+} SimPlane;
+
+// one model run
+typedef struct {
+    const AirportParameters *airport;
+    double      arrival_rate;   // planes per second
+    int         capacity[N_RESOURCE_TYPES];
+    int         free[N_RESOURCE_TYPES];
+    int         international_active;
+    double      now;
+    uint64_t    rng;
+    Runways     runways;
+
+    Event      *events;
+    int         n_events;
+    int         events_capacity;
+    uint64_t    seq;
+
+    SimPlane   *planes;
+    int         n_planes;
+    int         planes_capacity;
+    int        *waiting;        // planes waiting for resources, in request order
+    int         n_waiting;
+
+    double     *waits;
+    int         n_waits;
+    int         waits_capacity;
+
+    int         finished;
+    int         crashes;
+} Sim;
+
+// result of a configuration
+typedef struct {
+    double  p99_wait;
+    int     crashes;
+    bool    meets_sla;
+} Evaluation;
+
+// search state shared by the workers
+typedef struct {
+    const AirportParameters *airport;
+    const CapacitySLA       *sla;
+    pthread_mutex_t          mutex;
+    int                      n_jobs;
+    int                      next_job;
+    int                     *job_tracks;
+    int                     *job_tower;
+    int                     *min_gates;     // per (tracks, tower) cell
+    Evaluation              *at_min_gates;
+    int                      evaluations;
+    int                      pruned;
+} Search;
+
+#define GATES_UNKNOWN       (-1)
+#define GATES_INFEASIBLE    0
+#define CELL(tracks, tower) (((tracks) - 1) * CAPACITY_MAX_TOWER + ((tower) - 1))
+
+static void *
+grow(void *array, int *capacity, size_t size)
+{
+    *capacity = (*capacity == 0) ? 64 : *capacity * 2;
+    void *grown = realloc(array, *capacity * size);
+    if (grown == NULL) {
+        perror("--> falha ao alocar memória para a busca de capacidade");
+        exit(1);
+    }
+    return grown;
+}
+
+// event heap
+static bool
+event_before(const Event *a, const Event *b)
+{
+    return (a->at < b->at) || (a->at == b->at && a->seq < b->seq);
+}
+
+static void
+schedule(Sim *sim, double at, EventKind kind, int plane, int phase)
+{
+    if (sim->n_events == sim->events_capacity) {
+        sim->events = grow(sim->events, &sim->events_capacity, sizeof(Event));
+    }
+    Event event = { at, sim->seq++, kind, plane, phase };
+    int i = sim->n_events++;
+    while (i > 0 && event_before(&event, &sim->events[(i - 1) / 2])) {
+        sim->events[i] = sim->events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    sim->events[i] = event;
+}
+
+static Event
+next_event(Sim *sim)
+{
+    Event top = sim->events[0];
+    Event last = sim->events[--sim->n_events];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= sim->n_events) break;
+        if (child + 1 < sim->n_events && event_before(&sim->events[child + 1], &sim->events[child])) {
+            child++;
+        }
+        if (!event_before(&sim->events[child], &last)) break;
+        sim->events[i] = sim->events[child];
+        i = child;
+    }
+    if (sim->n_events > 0) {
+        sim->events[i] = last;
+    }
+    return top;
+}
+
+static void
+record_wait(Sim *sim, double wait)
+{
+    if (sim->n_waits == sim->waits_capacity) {
+        sim->waits = grow(sim->waits, &sim->waits_capacity, sizeof(double));
+    }
+    sim->waits[sim->n_waits++] = wait;
+}
+
+static void
+stop_waiting(Sim *sim, int plane)
+{
+    for (int i = 0; i < sim->n_waiting; i++) {
+        if (sim->waiting[i] == plane) {
+            memmove(&sim->waiting[i], &sim->waiting[i + 1], (sim->n_waiting - i - 1) * sizeof(int));
+            sim->n_waiting--;
+            break;
+        }
+    }
+    sim->planes[plane].waiting = false;
+}
+
+static void
+leave(Sim *sim, int plane)
+{
+    if (sim->planes[plane].type == INTERNATIONAL) {
+        sim->international_active--;
+    }
+}
+
+static double
+service_time(Sim *sim, const Phase *phase)
+{
+    return rng_uniform(&sim->rng, phase->min_usec / 1e6, phase->max_usec / 1e6);
+}
+
+static void
+request_phase(Sim *sim, int plane, int phase)
+{
+    const PhaseClass *class = &PHASES[phase].classes[sim->planes[plane].type];
+    SimPlane *p = &sim->planes[plane];
+    p->phase = phase;
+
+    // no resources involved, just time passing
+    if (class->n_resources == 0) {
+        schedule(sim, sim->now + service_time(sim, &PHASES[phase]), EVENT_PHASE_END, plane, phase);
+        return;
+    }
+
+    p->waiting = true;
+    p->acquired = 0;
+    p->requested_at = sim->now;
+    sim->waiting[sim->n_waiting++] = plane;
+
+    // a phase stuck for TIME_TILL_DEADLOCK is flagged as deadlock by the simulator
+    int limit = TIME_TILL_CRASH;
+    if (PHASES[phase].checks_deadlock && TIME_TILL_DEADLOCK < limit) {
+        limit = TIME_TILL_DEADLOCK;
+    }
+    schedule(sim, sim->now + limit, EVENT_TIMEOUT, plane, phase);
+}
+
+static bool
+uses_runway(const PhaseClass *class)
+{
+    if (!SEQUENCER_ENABLED) return false;
+    for (int r = 0; r < class->n_resources; r++) {
+        if (class->order[r] == RESOURCE_TRACK) return true;
+    }
+    return false;
+}
+
+// grants resources to waiting planes, internationals first, each class in request order
+static void
+dispatch(Sim *sim)
+{
+    static const FlightType passes[] = { INTERNATIONAL, DOMESTIC };
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < sim->n_waiting; i++) {
+            int plane = sim->waiting[i];
+            SimPlane *p = &sim->planes[plane];
+            if (p->type != passes[pass]) continue;
+
+            const PhaseClass *class = &PHASES[p->phase].classes[p->type];
+            if (class->yields_to_international && !p->priority_cleared) {
+                if (sim->international_active > 0) continue;
+                p->priority_cleared = true;
+            }
+
+            // take what is free in order, holding it while the rest is busy
+            while (p->acquired < class->n_resources && sim->free[class->order[p->acquired]] > 0) {
+                ResourceType resource = class->order[p->acquired++];
+                sim->free[resource]--;
+
+                // the runway is held from now on, the operation starts after the separation
+                if (resource == RESOURCE_TRACK && uses_runway(class)) {
+                    p->runway = runways_first_ready(&sim->runways, PHASES[p->phase].runway, &p->runway_ready);
+                    runways_take(&sim->runways, p->runway);
+                }
+            }
+            if (p->acquired < class->n_resources) continue;
+
+            double start = sim->now;
+            if (uses_runway(class) && p->runway_ready > start) start = p->runway_ready;
+            record_wait(sim, start - p->requested_at);
+            stop_waiting(sim, plane);
+            p->priority_cleared = false;
+            schedule(sim, start + service_time(sim, &PHASES[p->phase]), EVENT_PHASE_END, plane, p->phase);
+            i--;
+        }
+    }
+}
+
+static void
+advance(Sim *sim, int plane, int phase)
+{
+    for (int next = phase + 1; next < N_PHASES; next++) {
+        if (phase_enabled(&PHASES[next], sim->capacity)) {
+            request_phase(sim, plane, next);
+            return;
+        }
+    }
+    sim->finished++;
+    leave(sim, plane);
+}
+
+static void
+handle(Sim *sim, const Event *event)
+{
+    const Phase *phase = &PHASES[event->phase];
+
+    switch (event->kind) {
+        case EVENT_ARRIVAL: {
+            if (sim->n_planes == sim->planes_capacity) {
+                int capacity = sim->planes_capacity;
+                sim->planes = grow(sim->planes, &sim->planes_capacity, sizeof(SimPlane));
+                sim->waiting = grow(sim->waiting, &capacity, sizeof(int));
+            }
+            int plane = sim->n_planes++;
+            SimPlane *p = &sim->planes[plane];
+            memset(p, 0, sizeof(*p));
+            bool international = rng_random(&sim->rng) * 100 < sim->airport->international_flights_percentage;
+            p->type = international ? INTERNATIONAL : DOMESTIC;
+            if (international) {
+                sim->international_active++;
+            }
+            request_phase(sim, plane, 0);
+
+            double next = sim->now - log(1.0 - rng_random(&sim->rng)) / sim->arrival_rate;
+            if (next < CAPACITY_HORIZON) {
+                schedule(sim, next, EVENT_ARRIVAL, -1, 0);
+            }
+            break;
+        }
+        case EVENT_PHASE_END: {
+            const PhaseClass *class = &phase->classes[sim->planes[event->plane].type];
+            if (uses_runway(class)) {
+                runways_release(&sim->runways, sim->planes[event->plane].runway, phase->runway, sim->now);
+            }
+            for (int r = 0; r < class->n_resources; r++) {
+                if (phase->hold_usec > 0 && class->order[r] == phase->held) continue;
+                sim->free[class->order[r]]++;
+            }
+            if (phase->hold_usec > 0 && class->n_resources > 0) {
+                schedule(sim, sim->now + phase->hold_usec / 1e6, EVENT_HOLD_RELEASE, event->plane, event->phase);
+                break;
+            }
+            advance(sim, event->plane, event->phase);
+            break;
+        }
+        case EVENT_HOLD_RELEASE:
+            sim->free[phase->held]++;
+            advance(sim, event->plane, event->phase);
+            break;
+        case EVENT_TIMEOUT: {
+            SimPlane *p = &sim->planes[event->plane];
+            if (!p->waiting || p->phase != event->phase) break;
+            record_wait(sim, sim->now - p->requested_at);
+            stop_waiting(sim, event->plane);
+            const PhaseClass *class = &phase->classes[p->type];
+            for (int r = 0; r < p->acquired; r++) {
+                sim->free[class->order[r]]++;
+                if (class->order[r] == RESOURCE_TRACK && uses_runway(class)) sim->runways.busy[p->runway] = false;
+            }
+            sim->crashes++;
+            leave(sim, event->plane);
+            break;
+        }
+    }
+    dispatch(sim);
+}
+
+static int
+compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// one seeded run of the model; returns the p99 wait and fills 'crashes'
+static double
+run_model(const Search *search, int tracks, int gates, int tower, uint64_t seed, int *crashes)
+{
+    Sim sim;
+    memset(&sim, 0, sizeof(sim));
+    sim.airport = search->airport;
+    sim.arrival_rate = search->sla->arrival_rate / 60.0;
+    sim.capacity[RESOURCE_TRACK] = tracks;
+    sim.capacity[RESOURCE_GATE] = gates;
+    sim.capacity[RESOURCE_TOWER] = tower;
+    sim.capacity[RESOURCE_TAXIWAY] = N_TAXIWAYS;
+    sim.capacity[RESOURCE_FUEL_TRUCK] = N_FUEL_TRUCKS;
+    memcpy(sim.free, sim.capacity, sizeof(sim.free));
+    runways_reset(&sim.runways, tracks);
+    sim.rng = rng_seed(seed);
+
+    schedule(&sim, 0.0, EVENT_ARRIVAL, -1, 0);
+    while (sim.n_events > 0) {
+        Event event = next_event(&sim);
+        sim.now = event.at;
+        handle(&sim, &event);
+    }
+
+    double p99 = 0.0;
+    if (sim.n_waits > 0) {
+        qsort(sim.waits, sim.n_waits, sizeof(double), compare_doubles);
+        p99 = sim.waits[(int)ceil(0.99 * sim.n_waits) - 1];
+    }
+    *crashes = sim.crashes;
+
+    free(sim.events);
+    free(sim.planes);
+    free(sim.waiting);
+    free(sim.waits);
+    return p99;
+}
+
+// worst case over CAPACITY_REPLICATIONS runs
+static Evaluation
+evaluate(Search *search, int tracks, int gates, int tower)
+{
+    Evaluation evaluation = { 0.0, 0, false };
+    for (int r = 0; r < CAPACITY_REPLICATIONS; r++) {
+        int crashes;
+        double p99 = run_model(search, tracks, gates, tower, CAPACITY_SEED + r, &crashes);
+        if (p99 > evaluation.p99_wait) evaluation.p99_wait = p99;
+        if (crashes > evaluation.crashes) evaluation.crashes = crashes;
+    }
+    evaluation.meets_sla = evaluation.crashes <= search->sla->max_crashes
+                        && evaluation.p99_wait <= search->sla->max_p99_wait;
+
+    pthread_mutex_lock(&search->mutex);
+    search->evaluations++;
+    pthread_mutex_unlock(&search->mutex);
+    return evaluation;
+}
+
+/*
+ * each job is a (tracks, tower) pair whose minimum gate count is found by bisection.
+ * more of any resource never hurts, so results already known bound the range:
+ * pairs that dominate this one give a lower bound (or prove it infeasible) and
+ * pairs dominated by it give an upper bound that is known to meet the SLA.
+ */
+static void *
+search_worker(void *arg)
+{
+    Search *search = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&search->mutex);
+        if (search->next_job >= search->n_jobs) {
+            pthread_mutex_unlock(&search->mutex);
+            break;
+        }
+        int job = search->next_job++;
+        int tracks = search->job_tracks[job];
+        int tower = search->job_tower[job];
+
+        int low = 1, high = CAPACITY_MAX_GATES;
+        bool high_meets_sla = false, infeasible = false;
+        for (int t = 1; t <= CAPACITY_MAX_TRACKS; t++) {
+            for (int w = 1; w <= CAPACITY_MAX_TOWER; w++) {
+                int gates = search->min_gates[CELL(t, w)];
+                if (t >= tracks && w >= tower) {
+                    if (gates == GATES_INFEASIBLE) infeasible = true;
+                    else if (gates > low) low = gates;
+                }
+                if (t <= tracks && w <= tower && gates > 0 && gates <= high) {
+                    high = gates;
+                    high_meets_sla = true;
+                }
+            }
+        }
+        if (infeasible) {
+            search->min_gates[CELL(tracks, tower)] = GATES_INFEASIBLE;
+            search->pruned++;
+        }
+        pthread_mutex_unlock(&search->mutex);
+        if (infeasible) continue;
+
+        Evaluation best = { 0.0, 0, false };
+        if (!high_meets_sla) {
+            best = evaluate(search, tracks, high, tower);
+            if (!best.meets_sla) high = GATES_INFEASIBLE;
+        }
+        if (low > high) low = high;
+
+        while (high != GATES_INFEASIBLE && low < high) {
+            int middle = (low + high) / 2;
+            Evaluation evaluation = evaluate(search, tracks, middle, tower);
+            if (evaluation.meets_sla) {
+                high = middle;
+                best = evaluation;
+            } else {
+                low = middle + 1;
+            }
+        }
+
+        // the bound came from another pair, measure it here (walking up if runs disagree)
+        while (high != GATES_INFEASIBLE && !best.meets_sla) {
+            best = evaluate(search, tracks, high, tower);
+            if (!best.meets_sla && ++high > CAPACITY_MAX_GATES) high = GATES_INFEASIBLE;
+        }
+
+        pthread_mutex_lock(&search->mutex);
+        search->min_gates[CELL(tracks, tower)] = high;
+        search->at_min_gates[CELL(tracks, tower)] = best;
+        pthread_mutex_unlock(&search->mutex);
+    }
+
+    return NULL;
+}
+
+static bool
+dominated(const Search *search, int tracks, int tower)
+{
+    int gates = search->min_gates[CELL(tracks, tower)];
+    for (int t = 1; t <= tracks; t++) {
+        for (int w = 1; w <= tower; w++) {
+            int other = search->min_gates[CELL(t, w)];
+            if ((t != tracks || w != tower) && other > 0 && other <= gates) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int
+run_capacity_search(const AirportParameters *airport, const CapacitySLA *sla)
+{
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (CAPACITY_MAX_TRACKS > MAX_RUNWAYS) {
+        fprintf(stderr, "--> CAPACITY_MAX_TRACKS acima do máximo de pistas do modelo (MAX_RUNWAYS = %d)\n", MAX_RUNWAYS);
+        return -1;
+    }
+
+    int n_cells = CAPACITY_MAX_TRACKS * CAPACITY_MAX_TOWER;
+    Search search;
+    memset(&search, 0, sizeof(search));
+    search.airport = airport;
+    search.sla = sla;
+    search.n_jobs = n_cells;
+    search.job_tracks = malloc(n_cells * sizeof(int));
+    search.job_tower = malloc(n_cells * sizeof(int));
+    search.min_gates = malloc(n_cells * sizeof(int));
+    search.at_min_gates = calloc(n_cells, sizeof(Evaluation));
+    if (!search.job_tracks || !search.job_tower || !search.min_gates || !search.at_min_gates) {
+        perror("--> falha ao alocar memória para a busca de capacidade");
+        exit(1);
+    }
+    pthread_mutex_init(&search.mutex, NULL);
+
+    // largest pairs first, so infeasibility and lower bounds propagate downwards early
+    int job = 0;
+    for (int sum = CAPACITY_MAX_TRACKS + CAPACITY_MAX_TOWER; sum >= 2; sum--) {
+        for (int t = CAPACITY_MAX_TRACKS; t >= 1; t--) {
+            int w = sum - t;
+            if (w < 1 || w > CAPACITY_MAX_TOWER) continue;
+            search.job_tracks[job] = t;
+            search.job_tower[job] = w;
+            job++;
+        }
+    }
+    for (int i = 0; i < n_cells; i++) {
+        search.min_gates[i] = GATES_UNKNOWN;
+    }
+
+    long n_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_workers < 1) n_workers = 1;
+    if (n_workers > n_cells) n_workers = n_cells;
+
+    printf("--> busca de capacidade: %s\n", airport->long_name);
+    printf("  voos internacionais: %d%%\n", airport->international_flights_percentage);
+    printf("  taxa de chegada: %.2f aviões/min\n", sla->arrival_rate);
+    printf("  SLA: até %d quedas (starvation ou deadlock) e p99 de espera até %.1fs\n", sla->max_crashes, sla->max_p99_wait);
+    printf("  espaço de busca: %d pistas x %d portões x %d torre, %d execuções de %ds por configuração\n",
+           CAPACITY_MAX_TRACKS, CAPACITY_MAX_GATES, CAPACITY_MAX_TOWER, CAPACITY_REPLICATIONS, CAPACITY_HORIZON);
+    printf("  threads: %ld\n\n", n_workers);
+    fflush(stdout);
+
+    pthread_t *workers = malloc(n_workers * sizeof(pthread_t));
+    if (workers == NULL) {
+        perror("--> falha ao alocar memória para a busca de capacidade");
+        exit(1);
+    }
+    for (long i = 0; i < n_workers; i++) {
+        if (pthread_create(&workers[i], NULL, search_worker, &search) != 0) {
+            perror("--> falha ao criar thread de busca");
+            exit(1);
+        }
+    }
+    for (long i = 0; i < n_workers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+
+    printf("--> CONFIGURAÇÕES PARETO-MÍNIMAS:\n");
+    printf("  %6s %8s %6s %10s %7s\n", "pistas", "portões", "torre", "p99 (s)", "quedas");
+    int found = 0;
+    for (int t = 1; t <= CAPACITY_MAX_TRACKS; t++) {
+        for (int w = 1; w <= CAPACITY_MAX_TOWER; w++) {
+            int gates = search.min_gates[CELL(t, w)];
+            if (gates <= 0 || dominated(&search, t, w)) continue;
+            Evaluation *e = &search.at_min_gates[CELL(t, w)];
+            printf("  %6d %8d %6d %10.2f %7d\n", t, gates, w, e->p99_wait, e->crashes);
+            found++;
+        }
+    }
+    if (found == 0) {
+        printf("  nenhuma configuração dentro dos limites atende ao SLA\n");
+    }
+
+    bool current_in_range = N_TRACKS <= CAPACITY_MAX_TRACKS && N_TOWER_MAX_OPERATIONS <= CAPACITY_MAX_TOWER;
+    if (current_in_range) {
+        int gates = search.min_gates[CELL(N_TRACKS, N_TOWER_MAX_OPERATIONS)];
+        printf("\n--> configuração atual (config.h): %d pistas, %d portões, %d torre\n",
+               N_TRACKS, N_GATES, N_TOWER_MAX_OPERATIONS);
+        if (gates > 0) {
+            printf("  portões necessários com essas pistas e torre: %d (%s)\n", gates,
+                   (N_GATES >= gates) ? "atende ao SLA" : "não atende ao SLA");
+        } else {
+            printf("  nenhuma quantidade de portões atende ao SLA com essas pistas e torre\n");
+        }
+    }
+
+    printf("\n--> %d configurações avaliadas, %d podadas, %.2fs\n",
+           search.evaluations, search.pruned, seconds_since(&start));
+
+    pthread_mutex_destroy(&search.mutex);
+    free(search.job_tracks);
+    free(search.job_tower);
+    free(search.min_gates);
+    free(search.at_min_gates);
+    return found;
+}
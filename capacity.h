@@ -0,0 +1,18 @@
+// capacity.h
+#ifndef CAPACITY_H
+#define CAPACITY_H
+
+#include "params.h"
+
+// service level the search has to meet
+typedef struct {
+    double arrival_rate;    // planes per minute
+    double max_p99_wait;    // seconds
+    int    max_crashes;     // starvation + deadlock crashes per run
+} CapacitySLA;
+
+// searches for the pareto-minimal (tracks, gates, tower) configurations that
+// meet 'sla' for the given airport profile; returns the number of configurations found
+int run_capacity_search(const AirportParameters *airport, const CapacitySLA *sla);
+
+#endif /* CAPACITY_H */
@@ -31,9 +31,138 @@ static const int SIM_DURATION               = 60;   // seconds
 static const int N_TRACKS                   = 3;    // number of tracks
 static const int N_GATES                    = 5;    // number of gates
 static const int N_TOWER_MAX_OPERATIONS     = 2;    // max number of simultaneous operations the tower can do
+static const int N_TAXIWAYS                 = 0;    // number of taxiways, 0 skips the taxi phase
+static const int N_FUEL_TRUCKS              = 0;    // number of fuel trucks, 0 skips the refuel phase
 static const int MAX_N_PLANES               = 200;  // maximum number of planes #TODO
 static const int TIME_TILL_CRITICAL_STATE   = 60;   // time till critical state in seconds
 static const int TIME_TILL_CRASH            = 90;   // time till crash in seconds
 static const int WAITING_TIMEOUT            = 60;   // waiting timeout
+static const int TIME_TILL_DEADLOCK         = 30;   // landing wait after which a deadlock is assumed
+/*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+ *
+ * 3) capacity planning search (./margolis --capacity)
+ *
+ * a discrete-event model of the plane lifecycle is run in simulated time for every
+ * (tracks, gates, tower) candidate, so the whole search takes seconds instead of
+ * one SIM_DURATION run per configuration. the SLA below can be overridden with
+ * --rate, --p99 and --crashes, and the airport profile with --airport.
+ *
+ * every phase takes its resources one at a time in class order, holding what it
+ * has, so crashes cover deadlocks between classes as well as starvation timeouts.
+ *
+ * with SEQUENCER_ENABLED the model keeps each runway's last operation and applies
+ * the SEPARATION_* values of section 7 before granting a track. it serves runways
+ * in request order, so it does not credit the sequencer's reordering.
+ *
+ */
+static const double CAPACITY_ARRIVAL_RATE       = 10.9;  // planes per minute (spawn_planes averages one every 5.5s)
+static const double CAPACITY_MAX_P99_WAIT       = 30.0;  // seconds
+static const int    CAPACITY_MAX_CRASHES        = 0;     // crashes tolerated per run
+static const int    CAPACITY_MAX_TRACKS         = 8;     // search space upper bounds
+static const int    CAPACITY_MAX_GATES          = 24;
+static const int    CAPACITY_MAX_TOWER          = 8;
+static const int    CAPACITY_HORIZON            = 3600;  // simulated seconds of arrivals per run
+static const int    CAPACITY_REPLICATIONS       = 4;     // runs per configuration, worst one counts
+static const unsigned CAPACITY_SEED             = 2024;  // same seeds for every configuration
+/*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+ *
+ * 4) admission control
+ *
+ * arriving planes enter a holding pattern and only get a thread once the airport
+ * has room for them, most urgent (least fuel left) first. a plane that runs out
+ * of holding fuel, or that does not fit in a full holding pattern, diverts.
+ *
+ * policies (HOLDING_POLICY):
+ *   - DIVERT_ARRIVAL       the arriving plane diverts
+ *   - DIVERT_MOST_FUEL     the plane with the most fuel left diverts
+ *
+ */
+static const int           ADMISSION_CONTROL            = 1;   // 0 starts every plane as soon as it arrives
+static const int           ADMISSION_MAX_APPROACHING    = 3;   // admitted planes that have not landed yet
+static const int           ADMISSION_MAX_ACTIVE         = 10;  // admitted planes still in the airport
+static const int           HOLDING_QUEUE_SIZE           = 32;  // planes in the holding pattern
+static const int           HOLDING_MIN_FUEL             = 60;  // seconds of holding fuel on arrival
+static const int           HOLDING_MAX_FUEL             = 180;
+static const HoldingPolicy HOLDING_POLICY               = DIVERT_MOST_FUEL;
+/*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+ *
+ * 5) schedule exploration (./margolis --explore)
+ *
+ * the PHASES[] lifecycle runs under a controlled scheduler in simulated time and
+ * the scheduler decides which plane moves at every acquire, release and priority
+ * check. schedules are seeded and replayable, and the smallest one ending in a
+ * deadlock or a TIME_TILL_CRASH starvation is printed with its trace.
+ * with SEQUENCER_ENABLED a track is only acquired from an idle runway whose
+ * separation has passed, as the sequencer of section 7 hands them out.
+ *
+ * strategies (EXPLORE_STRATEGY, --strategy):
+ *   - EXPLORE_PCT          pct: random plane priorities, EXPLORE_DEPTH - 1 change points
+ *   - EXPLORE_RANDOM       random: any runnable plane
+ *   - EXPLORE_DFS          dfs: every alternative of the first EXPLORE_DEPTH decisions
+ *
+ */
+static const ExploreStrategy EXPLORE_STRATEGY               = EXPLORE_PCT;
+static const int             EXPLORE_SCHEDULES              = 5000; // schedules per number of planes
+static const int             EXPLORE_MIN_PLANES             = 2;
+static const int             EXPLORE_MAX_PLANES             = 10;
+static const int             EXPLORE_DEPTH                  = 3;
+static const int             EXPLORE_ARRIVAL_WINDOW         = 10;   // seconds over which the planes arrive
+static const double          EXPLORE_TICK                   = 0.5;  // seconds, step times are rounded up to it
+static const int             EXPLORE_INTERNATIONAL_PERCENT  = 50;   // mixed traffic, --airport uses the profile's
+static const unsigned        EXPLORE_SEED                   = 1;
+/*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+ *
+ * 6) metrics
+ *
+ * prometheus text-format metrics served over http while the simulation runs:
+ *
+ *   $ curl --unix-socket /tmp/margolis.sock http://localhost/metrics
+ *
+ */
+static const int          METRICS_ENABLED       = 1;
+static const char * const METRICS_SOCKET_PATH   = "/tmp/margolis.sock";   // unix domain socket
+static const int          METRICS_PORT          = 0;    // serve on 127.0.0.1:<port> instead, 0 uses the socket
+/*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+ *
+ * 7) runway sequencing
+ *
+ * tracks are handed out by a sequencer instead of first-come-first-served. among the
+ * pending operations that arrived within SEQUENCER_WINDOW of the oldest one, it
+ * picks the one with the shortest separation after the runway's last operation,
+ * then international flights, then the oldest. the final report replays the
+ * recorded runway demand under both policies to show the gain over FCFS.
+ *
+ */
+static const int    SEQUENCER_ENABLED           = 1;
+static const double SEQUENCER_WINDOW            = 3.0;  // seconds an operation can be overtaken for
+static const int    SEQUENCER_CLASS_PRIORITY    = 1;    // international first among equal separations
+static const double SEPARATION_LANDING_LANDING  = 0.3;  // seconds between consecutive runway operations
+static const double SEPARATION_LANDING_TAKEOFF  = 0.5;
+static const double SEPARATION_TAKEOFF_LANDING  = 0.6;
+static const double SEPARATION_TAKEOFF_TAKEOFF  = 0.2;
+/*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+ *
+ * 8) reservations
+ *
+ * when a plane starts, it books runway and gate slots for its whole lifecycle in a
+ * calendar of RESERVATION_SLOT seconds per unit. other planes stay off a booked unit;
+ * a plane more than RESERVATION_TOLERANCE late loses its slots and books again.
+ *
+ */
+static const int    RESERVATIONS_ENABLED    = 0;    // off until a run shows shorter waits with it
+static const double RESERVATION_SLOT        = 0.25; // seconds
+static const double RESERVATION_TOLERANCE   = 1.0;  // seconds late that still keep the booking
+/*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
+ *
+ * 9) performance counters
+ *
+ * cycles, instructions, cache misses, context switches and page faults from
+ * perf_event_open, per plane generation, lifecycle phase and final report. they are
+ * printed after the final report and written to PERF_OUTPUT_PATH for benchmarks;
+ * counters the kernel does not allow are left out.
+ *
+ */
+static const int          PERF_COUNTERS_ENABLED = 1;
+static const char * const PERF_OUTPUT_PATH      = "margolis-perf.txt";
 /*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*/
 #endif /* CONFIG_H */
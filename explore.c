@@ -0,0 +1,604 @@
+// explore.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "config.h"
+#include "params.h"
+#include "lifecycle.h"
+#include "rng.h"
+#include "timing.h"
+#include "explore.h"
+#include "sequencer.h"
+
+/*
+ * instead of racing real threads, each plane runs as a list of steps built from
+ * PHASES[] and a controlled scheduler executes them one at a time. whenever more
+ * than one plane can acquire, release or pass the priority check at the same
+ * simulated instant, the strategy picks which one goes: that choice is the only
+ * source of nondeterminism, so a (seed, choices) pair replays a schedule exactly.
+ *
+ * with SEQUENCER_ENABLED, a track is acquired from an idle runway once the
+ * separation after its last operation has passed, as in the simulation. the order
+ * the sequencer would pick is one of the orders the scheduler already explores.
+ */
+
+#define MAX_STEPS       128
+#define MAX_PLANES      32
+#define MAX_DECISIONS   4096
+#define MAX_DEPTH       16
+
+typedef enum {
+    STEP_ARRIVE,
+    STEP_BEGIN_PHASE,
+    STEP_PRIORITY,          // decision point
+    STEP_ACQUIRE,           // decision point
+    STEP_DEADLOCK_CHECK,
+    STEP_SERVICE,
+    STEP_RELEASE,           // decision point
+    STEP_HOLD,
+    STEP_DONE
+} StepKind;
+
+typedef struct {
+    StepKind        kind;
+    int             phase;
+    ResourceType    resource;
+    double          duration;
+} Step;
+
+// plane under the controlled scheduler
+typedef struct {
+    FlightType  type;
+    Step        steps[MAX_STEPS];
+    int         n_steps;
+    int         pc;
+    double      ready_at;
+    double      waiting_since;
+    int         held[N_RESOURCE_TYPES];
+    int         runway;
+    bool        finished;
+} ExplorePlane;
+
+typedef enum {
+    OUTCOME_OK,
+    OUTCOME_DEADLOCK,               // every unfinished plane is blocked for good
+    OUTCOME_DEADLOCK_DETECTED,      // potential_deadlock_detected() would fire
+    OUTCOME_STARVATION,             // a plane waited more than TIME_TILL_CRASH
+    N_OUTCOMES
+} Outcome;
+
+static const char *OUTCOME_NAMES[N_OUTCOMES] = {
+    [OUTCOME_OK]                = "ok",
+    [OUTCOME_DEADLOCK]          = "deadlock",
+    [OUTCOME_DEADLOCK_DETECTED] = "deadlock detectado",
+    [OUTCOME_STARVATION]        = "starvation",
+};
+
+static const char *STRATEGY_NAMES[] = {
+    [EXPLORE_PCT]       = "pct",
+    [EXPLORE_RANDOM]    = "random",
+    [EXPLORE_DFS]       = "dfs",
+};
+
+// one schedule
+typedef struct {
+    const ExploreOptions *options;
+    unsigned        seed;
+    int             n_planes;
+    ExplorePlane    planes[MAX_PLANES];
+    int             capacity[N_RESOURCE_TYPES];
+    int             free[N_RESOURCE_TYPES];
+    Runways         runways;
+    int             international_active;
+    double          now;
+    int             failed_plane;
+
+    // scheduler
+    uint64_t        rng;
+    int             priority[MAX_PLANES];
+    int             change_points[MAX_DEPTH];
+    int             n_change_points;
+    const int      *forced;                     // decisions replayed before the strategy takes over
+    int             n_forced;
+    int             choices[MAX_DECISIONS];
+    int             alternatives[MAX_DECISIONS];
+    int             n_decisions;
+    int             steps;
+    bool            trace;
+} Run;
+
+static void
+add_step(ExplorePlane *plane, StepKind kind, int phase, ResourceType resource, double duration)
+{
+    if (plane->n_steps == MAX_STEPS) {
+        fprintf(stderr, "--> fases demais para a exploração (MAX_STEPS = %d)\n", MAX_STEPS);
+        exit(1);
+    }
+    Step step = { kind, phase, resource, duration };
+    plane->steps[plane->n_steps++] = step;
+}
+
+// times are rounded up to EXPLORE_TICK so that planes meet at the same instant, as
+// real threads do within scheduling jitter, and the scheduler gets to order them
+static double
+to_tick(double seconds)
+{
+    return ceil(seconds / EXPLORE_TICK) * EXPLORE_TICK;
+}
+
+static double
+service_time(uint64_t *rng, int min_usec, int max_usec)
+{
+    return to_tick(rng_uniform(rng, min_usec / 1e6, max_usec / 1e6));
+}
+
+// arrivals, flight types and service times come from the seed, decisions do not
+static void
+build_workload(Run *run)
+{
+    uint64_t rng = rng_seed(run->seed);
+
+    for (int i = 0; i < run->n_planes; i++) {
+        ExplorePlane *plane = &run->planes[i];
+        memset(plane, 0, sizeof(*plane));
+        plane->type = (rng_below(&rng, 100) < run->options->international_percentage) ? INTERNATIONAL : DOMESTIC;
+        plane->ready_at = to_tick(rng_uniform(&rng, 0, EXPLORE_ARRIVAL_WINDOW));
+
+        add_step(plane, STEP_ARRIVE, 0, 0, 0);
+        for (int p = 0; p < N_PHASES; p++) {
+            const Phase *phase = &PHASES[p];
+            const PhaseClass *class = &phase->classes[plane->type];
+            if (!phase_enabled(phase, run->capacity)) continue;
+
+            add_step(plane, STEP_BEGIN_PHASE, p, 0, 0);
+            if (class->yields_to_international) {
+                add_step(plane, STEP_PRIORITY, p, 0, 0);
+            }
+            for (int r = 0; r < class->n_resources; r++) {
+                add_step(plane, STEP_ACQUIRE, p, class->order[r], 0);
+                if (phase->checks_deadlock && r + 1 < class->n_resources) {
+                    add_step(plane, STEP_DEADLOCK_CHECK, p, 0, 0);
+                }
+            }
+            add_step(plane, STEP_SERVICE, p, 0, service_time(&rng, phase->min_usec, phase->max_usec));
+            for (int r = class->n_resources - 1; r >= 0; r--) {
+                if (phase->hold_usec > 0 && class->order[r] == phase->held) continue;
+                add_step(plane, STEP_RELEASE, p, class->order[r], 0);
+            }
+            if (phase->hold_usec > 0 && class->n_resources > 0) {
+                add_step(plane, STEP_HOLD, p, 0, to_tick(phase->hold_usec / 1e6));
+                add_step(plane, STEP_RELEASE, p, phase->held, 0);
+            }
+        }
+        add_step(plane, STEP_DONE, 0, 0, 0);
+    }
+}
+
+static void
+init_scheduler(Run *run)
+{
+    run->rng = rng_seed(run->seed ^ 0x5BD1E995u);
+    if (run->options->strategy != EXPLORE_PCT) return;
+
+    // pct: distinct initial priorities above every change point priority
+    int depth = run->options->depth;
+    for (int i = 0; i < run->n_planes; i++) {
+        run->priority[i] = depth + i;
+    }
+    for (int i = run->n_planes - 1; i > 0; i--) {
+        int j = rng_below(&run->rng, i + 1);
+        int swap = run->priority[i];
+        run->priority[i] = run->priority[j];
+        run->priority[j] = swap;
+    }
+
+    int decision_steps = 0;
+    for (int i = 0; i < run->n_planes; i++) {
+        for (int s = 0; s < run->planes[i].n_steps; s++) {
+            StepKind kind = run->planes[i].steps[s].kind;
+            if (kind == STEP_PRIORITY || kind == STEP_ACQUIRE || kind == STEP_RELEASE) decision_steps++;
+        }
+    }
+    run->n_change_points = (depth - 1 < MAX_DEPTH) ? depth - 1 : MAX_DEPTH;
+    for (int i = 0; i < run->n_change_points; i++) {
+        run->change_points[i] = 1 + rng_below(&run->rng, decision_steps);
+    }
+}
+
+static bool
+is_decision(const Step *step)
+{
+    return step->kind == STEP_PRIORITY || step->kind == STEP_ACQUIRE || step->kind == STEP_RELEASE;
+}
+
+static bool
+sequenced(const Step *step)
+{
+    return SEQUENCER_ENABLED && step->resource == RESOURCE_TRACK;
+}
+
+// when the first idle runway can take the track this step acquires, INFINITY if none is idle
+static double
+runway_ready_at(const Run *run, const Step *step)
+{
+    double ready_at;
+    if (runways_first_ready(&run->runways, PHASES[step->phase].runway, &ready_at) < 0) return INFINITY;
+    return to_tick(ready_at);
+}
+
+static bool
+enabled(const Run *run, const ExplorePlane *plane)
+{
+    const Step *step = &plane->steps[plane->pc];
+    switch (step->kind) {
+        case STEP_PRIORITY:
+            return run->international_active == 0;
+        case STEP_ACQUIRE:
+            if (sequenced(step)) return runway_ready_at(run, step) <= run->now;
+            return run->free[step->resource] > 0;
+        default:
+            return true;
+    }
+}
+
+static void
+trace_step(const Run *run, int plane_id, const char *operation, const char *details)
+{
+    if (!run->trace) return;
+    printf("  [%7.2f] avião %d (%s): %s - %s\n", run->now, plane_id,
+           (run->planes[plane_id].type == INTERNATIONAL) ? "INTERNACIONAL" : "DOMESTICO",
+           operation, details);
+}
+
+// executes the next step of a plane; returns false when that step fails the schedule
+static bool
+execute(Run *run, int plane_id)
+{
+    ExplorePlane *plane = &run->planes[plane_id];
+    const Step *step = &plane->steps[plane->pc++];
+    const Phase *phase = &PHASES[step->phase];
+    char details[128];
+
+    switch (step->kind) {
+        case STEP_ARRIVE:
+            if (plane->type == INTERNATIONAL) run->international_active++;
+            trace_step(run, plane_id, "INICIO", "avião chegando ao aeroporto");
+            break;
+        case STEP_BEGIN_PHASE:
+            plane->waiting_since = run->now;
+            break;
+        case STEP_PRIORITY:
+            trace_step(run, plane_id, phase->log_name, "prioridade liberada");
+            break;
+        case STEP_ACQUIRE:
+            if (sequenced(step)) {
+                double ready_at;
+                plane->runway = runways_first_ready(&run->runways, phase->runway, &ready_at);
+                runways_take(&run->runways, plane->runway);
+            }
+            run->free[step->resource]--;
+            plane->held[step->resource]++;
+            trace_step(run, plane_id, phase->log_name, RESOURCES[step->resource].acquired);
+            break;
+        case STEP_DEADLOCK_CHECK:
+            if (run->now - plane->waiting_since > TIME_TILL_DEADLOCK) {
+                snprintf(details, sizeof(details), "detectado durante %s", phase->action);
+                trace_step(run, plane_id, "DEADLOCK", details);
+                run->failed_plane = plane_id;
+                return false;
+            }
+            break;
+        case STEP_SERVICE:
+        case STEP_HOLD:
+            plane->ready_at = run->now + step->duration;
+            if (step->kind == STEP_SERVICE) {
+                snprintf(details, sizeof(details), "iniciando %s", phase->action);
+                trace_step(run, plane_id, phase->log_name, details);
+            }
+            break;
+        case STEP_RELEASE:
+            if (sequenced(step)) {
+                runways_release(&run->runways, plane->runway, phase->runway, run->now);
+            }
+            run->free[step->resource]++;
+            plane->held[step->resource]--;
+            snprintf(details, sizeof(details), "liberando %s", RESOURCES[step->resource].name);
+            trace_step(run, plane_id, phase->log_name, details);
+            break;
+        case STEP_DONE:
+            plane->finished = true;
+            if (plane->type == INTERNATIONAL) run->international_active--;
+            trace_step(run, plane_id, "SUCESSO", "operações concluídas com sucesso");
+            break;
+    }
+    return true;
+}
+
+// runs every step that is not a decision point, for every plane that is ready
+static bool
+settle(Run *run)
+{
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (int i = 0; i < run->n_planes; i++) {
+            ExplorePlane *plane = &run->planes[i];
+            while (!plane->finished && plane->ready_at <= run->now && !is_decision(&plane->steps[plane->pc])) {
+                if (!execute(run, i)) return false;
+                progress = true;
+            }
+        }
+    }
+    return true;
+}
+
+static int
+choose(Run *run, const int *runnable, int n)
+{
+    int choice = 0;
+
+    if (run->n_decisions < run->n_forced) {
+        choice = run->forced[run->n_decisions];
+        if (choice >= n) choice = n - 1;
+    } else if (run->options->strategy == EXPLORE_RANDOM) {
+        choice = rng_below(&run->rng, n);
+    } else if (run->options->strategy == EXPLORE_PCT) {
+        for (int i = 1; i < n; i++) {
+            if (run->priority[runnable[i]] > run->priority[runnable[choice]]) choice = i;
+        }
+    }
+
+    if (run->n_decisions < MAX_DECISIONS) {
+        run->choices[run->n_decisions] = choice;
+        run->alternatives[run->n_decisions] = n;
+    }
+    run->n_decisions++;
+    return choice;
+}
+
+static Outcome
+run_schedule(Run *run)
+{
+    run->now = 0;
+    run->steps = 0;
+    run->n_decisions = 0;
+    run->international_active = 0;
+    run->failed_plane = -1;
+    memcpy(run->free, run->capacity, sizeof(run->free));
+    runways_reset(&run->runways, run->capacity[RESOURCE_TRACK]);
+    build_workload(run);
+    init_scheduler(run);
+
+    for (;;) {
+        if (!settle(run)) return OUTCOME_DEADLOCK_DETECTED;
+
+        int runnable[MAX_PLANES], n_runnable = 0;
+        bool unfinished = false;
+        double next_event = INFINITY, next_crash = INFINITY;
+        int starving = -1;
+        for (int i = 0; i < run->n_planes; i++) {
+            ExplorePlane *plane = &run->planes[i];
+            if (plane->finished) continue;
+            unfinished = true;
+            if (plane->ready_at > run->now) {
+                if (plane->ready_at < next_event) next_event = plane->ready_at;
+            } else if (enabled(run, plane)) {
+                runnable[n_runnable++] = i;
+            } else {
+                // an idle runway may still be in its separation
+                const Step *step = &plane->steps[plane->pc];
+                if (step->kind == STEP_ACQUIRE && sequenced(step) && runway_ready_at(run, step) < next_event) {
+                    next_event = runway_ready_at(run, step);
+                }
+                if (plane->waiting_since + TIME_TILL_CRASH < next_crash) {
+                    next_crash = plane->waiting_since + TIME_TILL_CRASH;
+                    starving = i;
+                }
+            }
+        }
+
+        if (n_runnable > 0) {
+            int plane_id = runnable[(n_runnable > 1) ? choose(run, runnable, n_runnable) : 0];
+            execute(run, plane_id);
+            run->steps++;
+            for (int c = 0; c < run->n_change_points; c++) {
+                if (run->change_points[c] == run->steps) run->priority[plane_id] = c;
+            }
+            continue;
+        }
+
+        if (!unfinished) return OUTCOME_OK;
+        if (next_event == INFINITY) return OUTCOME_DEADLOCK;
+        if (next_crash <= next_event) {
+            run->now = next_crash;
+            run->failed_plane = starving;
+            return OUTCOME_STARVATION;
+        }
+        run->now = next_event;
+    }
+}
+
+// what every unfinished plane holds and waits for at the end of a traced schedule
+static void
+print_blocked_planes(const Run *run)
+{
+    for (int i = 0; i < run->n_planes; i++) {
+        const ExplorePlane *plane = &run->planes[i];
+        if (plane->finished) continue;
+
+        char held[128] = "";
+        for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+            if (plane->held[r] == 0) continue;
+            size_t length = strlen(held);
+            snprintf(held + length, sizeof(held) - length, "%s%s", length ? ", " : "", RESOURCES[r].name);
+        }
+        const Step *step = &plane->steps[plane->pc];
+        const char *waiting = (step->kind == STEP_ACQUIRE) ? RESOURCES[step->resource].name
+                            : (step->kind == STEP_PRIORITY) ? "prioridade internacional" : "nada";
+        printf("  avião %d: segura [%s], aguarda %s\n", i, held, waiting);
+    }
+}
+
+static void
+print_replay_command(const ExploreOptions *options, const Run *run)
+{
+    printf("  replay: ./margolis --explore --strategy=%s --depth=%d --planes=%d --seed=%u",
+           STRATEGY_NAMES[options->strategy], options->depth, run->n_planes, run->seed);
+    // the flight types are drawn from the airport's international percentage
+    if (options->airport >= 0) printf(" --airport=%d", options->airport);
+    printf(" --replay");
+    if (options->strategy == EXPLORE_DFS) {
+        int n = (run->n_decisions < MAX_DECISIONS) ? run->n_decisions : MAX_DECISIONS;
+        for (int i = 0; i < n; i++) {
+            printf("%c%d", (i == 0) ? '=' : ',', run->choices[i]);
+        }
+    }
+    printf("\n");
+}
+
+static int
+parse_choices(const char *text, int *choices)
+{
+    int n = 0;
+    while (text != NULL && *text != '\0' && n < MAX_DECISIONS) {
+        char *end;
+        choices[n++] = (int)strtol(text, &end, 10);
+        text = (*end == ',') ? end + 1 : NULL;
+    }
+    return n;
+}
+
+static void
+init_run(Run *run, const ExploreOptions *options, int n_planes, unsigned seed)
+{
+    run->options = options;
+    run->n_planes = n_planes;
+    run->seed = seed;
+    run->capacity[RESOURCE_TRACK] = N_TRACKS;
+    run->capacity[RESOURCE_GATE] = N_GATES;
+    run->capacity[RESOURCE_TOWER] = N_TOWER_MAX_OPERATIONS;
+    run->capacity[RESOURCE_TAXIWAY] = N_TAXIWAYS;
+    run->capacity[RESOURCE_FUEL_TRUCK] = N_FUEL_TRUCKS;
+}
+
+static Outcome
+replay(const ExploreOptions *options, int n_planes, unsigned seed, const int *forced, int n_forced)
+{
+    static Run run;
+    memset(&run, 0, sizeof(run));
+    init_run(&run, options, n_planes, seed);
+    run.forced = forced;
+    run.n_forced = n_forced;
+    run.trace = true;
+
+    Outcome outcome = run_schedule(&run);
+    printf("\n--> resultado: %s em %.2fs, %d passos, %d decisões\n",
+           OUTCOME_NAMES[outcome], run.now, run.steps, run.n_decisions);
+    if (outcome != OUTCOME_OK) {
+        if (run.failed_plane >= 0) {
+            printf("  avião %d esperando desde %.2fs\n", run.failed_plane, run.planes[run.failed_plane].waiting_since);
+        }
+        print_blocked_planes(&run);
+    }
+    return outcome;
+}
+
+int
+run_schedule_exploration(const ExploreOptions *options)
+{
+    static int forced[MAX_DECISIONS];
+    static Run run, best;
+
+    if (options->max_planes < 1 || options->max_planes > MAX_PLANES || options->min_planes < 1) {
+        fprintf(stderr, "--> número de aviões deve estar entre 1 e %d\n", MAX_PLANES);
+        return -1;
+    }
+    if (N_TRACKS > MAX_RUNWAYS) {
+        fprintf(stderr, "--> N_TRACKS acima do máximo de pistas da exploração (MAX_RUNWAYS = %d)\n", MAX_RUNWAYS);
+        return -1;
+    }
+
+    printf("--> exploração de escalonamentos: %s, profundidade %d\n",
+           STRATEGY_NAMES[options->strategy], options->depth);
+    printf("  recursos: %d pistas, %d portões, %d torre\n", N_TRACKS, N_GATES, N_TOWER_MAX_OPERATIONS);
+    printf("  voos internacionais: %d%%, chegadas em %ds\n\n",
+           options->international_percentage, EXPLORE_ARRIVAL_WINDOW);
+
+    if (options->replay) {
+        int n_forced = parse_choices(options->choices, forced);
+        return replay(options, options->max_planes, options->seed, forced, n_forced) != OUTCOME_OK;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long total_schedules = 0;
+    int failures = 0;
+    bool found = false;
+
+    // fewest planes first: the first plane count with a failure holds the minimal schedule
+    for (int n = options->min_planes; n <= options->max_planes && !found; n++) {
+        int counts[N_OUTCOMES] = {0};
+        int n_forced = 0;
+
+        for (int s = 0; s < options->schedules; s++) {
+            unsigned seed = (options->strategy == EXPLORE_DFS) ? options->seed : options->seed + s;
+            memset(&run, 0, sizeof(run));
+            init_run(&run, options, n, seed);
+            run.forced = forced;
+            run.n_forced = n_forced;
+
+            Outcome outcome = run_schedule(&run);
+            counts[outcome]++;
+            total_schedules++;
+            if (outcome != OUTCOME_OK) {
+                failures++;
+                if (!found || run.n_decisions < best.n_decisions
+                    || (run.n_decisions == best.n_decisions && run.steps < best.steps)) {
+                    best = run;
+                    found = true;
+                }
+            }
+
+            if (options->strategy != EXPLORE_DFS) continue;
+
+            // dfs: move to the next alternative of the deepest bounded decision
+            int depth = (run.n_decisions < options->depth) ? run.n_decisions : options->depth;
+            int d = depth - 1;
+            while (d >= 0 && run.choices[d] + 1 >= run.alternatives[d]) d--;
+            if (d < 0) break;
+            memcpy(forced, run.choices, d * sizeof(int));
+            forced[d] = run.choices[d] + 1;
+            n_forced = d + 1;
+        }
+
+        printf("  %2d aviões: %6d escalonamentos |", n, counts[OUTCOME_OK] + counts[OUTCOME_DEADLOCK]
+               + counts[OUTCOME_DEADLOCK_DETECTED] + counts[OUTCOME_STARVATION]);
+        for (int o = OUTCOME_DEADLOCK; o < N_OUTCOMES; o++) {
+            printf(" %s: %d |", OUTCOME_NAMES[o], counts[o]);
+        }
+        printf("\n");
+    }
+
+    double elapsed = seconds_since(&start);
+    printf("\n--> %ld escalonamentos em %.2fs (%.0f/s)\n", total_schedules, elapsed,
+           (elapsed > 0) ? total_schedules / elapsed : 0.0);
+
+    if (!found) {
+        printf("--> nenhum deadlock ou starvation encontrado\n");
+        return 0;
+    }
+
+    printf("\n--> MENOR ESCALONAMENTO COM FALHA: %d aviões, semente %u, %d decisões\n",
+           best.n_planes, best.seed, best.n_decisions);
+    print_replay_command(options, &best);
+    printf("\n");
+
+    int n_forced = (best.n_decisions < MAX_DECISIONS) ? best.n_decisions : MAX_DECISIONS;
+    replay(options, best.n_planes, best.seed, best.choices, n_forced);
+    return failures;
+}
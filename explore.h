@@ -0,0 +1,25 @@
+// explore.h
+#ifndef EXPLORE_H
+#define EXPLORE_H
+
+#include <stdbool.h>
+
+#include "params.h"
+
+typedef struct {
+    ExploreStrategy strategy;
+    int             schedules;                  // per number of planes
+    int             min_planes;
+    int             max_planes;
+    int             depth;
+    int             international_percentage;
+    int             airport;                    // --airport index the percentage came from, -1 if none
+    unsigned        seed;                       // first schedule seed, or the one replayed
+    bool            replay;                     // run only 'seed' with 'max_planes', printing its trace
+    const char     *choices;                    // decisions to replay, comma separated, or NULL
+} ExploreOptions;
+
+// explores plane interleavings; returns the number of failing schedules found
+int run_schedule_exploration(const ExploreOptions *options);
+
+#endif /* EXPLORE_H */
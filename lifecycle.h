@@ -0,0 +1,172 @@
+// lifecycle.h
+#ifndef LIFECYCLE_H
+#define LIFECYCLE_H
+
+#include <stdbool.h>
+
+// plane state
+typedef enum {
+    WAITING_FOR_LANDING,
+    DURING_LANDING,
+    WAITING_FOR_GATE,
+    DURING_DISEMBARK,
+    WAITING_FOR_TAKEOFF,
+    DURING_TAKEOFF,
+    FINISHED,
+    CRASHED_STARVATION,
+    CRASHED_DEADLOCK,
+    WAITING_FOR_TAXIWAY,
+    DURING_TAXI,
+    WAITING_FOR_FUEL,
+    DURING_REFUEL,
+    HOLDING,
+    DIVERTED,
+    N_PLANE_STATES
+} PlaneState;
+
+// flight type
+typedef enum {
+    DOMESTIC,
+    INTERNATIONAL,
+    N_FLIGHT_TYPES
+} FlightType;
+
+// airport resources, one counting semaphore each
+typedef enum {
+    RESOURCE_TRACK,
+    RESOURCE_GATE,
+    RESOURCE_TOWER,
+    RESOURCE_TAXIWAY,
+    RESOURCE_FUEL_TRUCK,
+    N_RESOURCE_TYPES
+} ResourceType;
+
+// what a phase does on the runway, for the sequencer
+typedef enum {
+    RUNWAY_NONE,
+    RUNWAY_LANDING,
+    RUNWAY_TAKEOFF,
+    N_RUNWAY_OPERATIONS
+} RunwayOperation;
+
+#define MAX_PHASE_RESOURCES 4
+
+typedef struct {
+    const char *name;
+    const char *acquired;   // log message once it is held
+} ResourceInfo;
+
+static const ResourceInfo RESOURCES[N_RESOURCE_TYPES] = {
+    [RESOURCE_TRACK]        = { "pista",                    "pista adquirida" },
+    [RESOURCE_GATE]         = { "portão",                   "portão adquirido" },
+    [RESOURCE_TOWER]        = { "torre",                    "torre adquirida" },
+    [RESOURCE_TAXIWAY]      = { "pista de taxiamento",      "pista de taxiamento adquirida" },
+    [RESOURCE_FUEL_TRUCK]   = { "caminhão de combustível",  "caminhão de combustível adquirido" },
+};
+
+// how one flight type goes through a phase
+typedef struct {
+    bool            yields_to_international;    // waits while international flights are active
+    int             n_resources;
+    ResourceType    order[MAX_PHASE_RESOURCES]; // acquisition order
+} PhaseClass;
+
+// lifecycle phase
+typedef struct {
+    const char     *log_name;
+    const char     *action;         // "recursos adquiridos, iniciando <action>"
+    const char     *done;
+    PlaneState      waiting_state;
+    PlaneState      active_state;
+    PhaseClass      classes[N_FLIGHT_TYPES];
+    int             min_usec;       // service time, uniform in [min_usec, max_usec)
+    int             max_usec;
+    ResourceType    held;           // kept for hold_usec after the others are released
+    int             hold_usec;
+    bool            checks_deadlock;
+    bool            marks_critical_state;   // counts a starvation case once the plane waits 60s
+    bool            optional;       // skipped when one of its resources has no units
+    RunwayOperation runway;         // how the sequencer treats its track
+} Phase;
+
+/*
+ * the plane lifecycle, run in order by plane_thread() and by the capacity model.
+ * the per-class acquisition orders are the ones the simulation was written with,
+ * international and domestic flights deliberately take resources in different orders.
+ */
+static const Phase PHASES[] = {
+    {
+        .log_name = "POUSO", .action = "pouso", .done = "concluído com sucesso",
+        .waiting_state = WAITING_FOR_LANDING, .active_state = DURING_LANDING,
+        .classes = {
+            [DOMESTIC]      = { true,  2, { RESOURCE_TOWER, RESOURCE_TRACK } },
+            [INTERNATIONAL] = { false, 2, { RESOURCE_TRACK, RESOURCE_TOWER } },
+        },
+        .min_usec = 500000, .max_usec = 1500000,    // 0.5 to 1.5 seconds
+        .checks_deadlock = true,
+        .marks_critical_state = true,
+        .runway = RUNWAY_LANDING,
+    },
+    {
+        .log_name = "TAXI", .action = "taxiamento", .done = "concluído com sucesso",
+        .waiting_state = WAITING_FOR_TAXIWAY, .active_state = DURING_TAXI,
+        .classes = {
+            [DOMESTIC]      = { true,  1, { RESOURCE_TAXIWAY } },
+            [INTERNATIONAL] = { false, 1, { RESOURCE_TAXIWAY } },
+        },
+        .min_usec = 300000, .max_usec = 900000,     // 0.3 to 0.9 seconds
+        .optional = true,
+    },
+    {
+        .log_name = "DESEMBARQUE", .action = "desembarque", .done = "concluído com sucesso",
+        .waiting_state = WAITING_FOR_GATE, .active_state = DURING_DISEMBARK,
+        .classes = {
+            [DOMESTIC]      = { true,  2, { RESOURCE_TOWER, RESOURCE_GATE } },
+            [INTERNATIONAL] = { false, 2, { RESOURCE_GATE, RESOURCE_TOWER } },
+        },
+        .min_usec = 1000000, .max_usec = 3000000,   // 1 to 3 seconds
+        .held = RESOURCE_GATE, .hold_usec = 500000,
+    },
+    {
+        .log_name = "ABASTECIMENTO", .action = "abastecimento", .done = "concluído com sucesso",
+        .waiting_state = WAITING_FOR_FUEL, .active_state = DURING_REFUEL,
+        .classes = {
+            [DOMESTIC]      = { true,  1, { RESOURCE_FUEL_TRUCK } },
+            [INTERNATIONAL] = { false, 1, { RESOURCE_FUEL_TRUCK } },
+        },
+        .min_usec = 1000000, .max_usec = 2500000,   // 1 to 2.5 seconds
+        .optional = true,
+    },
+    {
+        .log_name = "ESPERA", .action = "espera", .done = "concluída",
+        .waiting_state = WAITING_FOR_TAKEOFF, .active_state = WAITING_FOR_TAKEOFF,
+        .min_usec = 2000000, .max_usec = 5000000,   // 2 to 5 seconds, holds nothing
+    },
+    {
+        .log_name = "DECOLAGEM", .action = "decolagem", .done = "concluída com sucesso",
+        .waiting_state = WAITING_FOR_TAKEOFF, .active_state = DURING_TAKEOFF,
+        .classes = {
+            [DOMESTIC]      = { true,  3, { RESOURCE_TOWER, RESOURCE_GATE, RESOURCE_TRACK } },
+            [INTERNATIONAL] = { false, 3, { RESOURCE_GATE, RESOURCE_TRACK, RESOURCE_TOWER } },
+        },
+        .min_usec = 800000, .max_usec = 2000000,    // 0.8 to 2 seconds
+        .runway = RUNWAY_TAKEOFF,
+    },
+};
+
+static const int N_PHASES = sizeof(PHASES) / sizeof(PHASES[0]);
+
+// optional phases only run when every resource they use has units
+static inline bool
+phase_enabled(const Phase *phase, const int capacity[N_RESOURCE_TYPES])
+{
+    if (!phase->optional) return true;
+    for (int c = 0; c < N_FLIGHT_TYPES; c++) {
+        for (int i = 0; i < phase->classes[c].n_resources; i++) {
+            if (capacity[phase->classes[c].order[i]] <= 0) return false;
+        }
+    }
+    return true;
+}
+
+#endif /* LIFECYCLE_H */
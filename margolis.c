@@ -11,28 +11,18 @@
 #include <signal.h>
 #include <sys/time.h>
 #include <errno.h>
+#include <getopt.h>
 
 #include "config.h"
 #include "params.h"
-
-// plane state
-typedef enum {
-    WAITING_FOR_LANDING,
-    DURING_LANDING,
-    WAITING_FOR_GATE,
-    DURING_DISEMBARK,
-    WAITING_FOR_TAKEOFF,
-    DURING_TAKEOFF,
-    FINISHED,
-    CRASHED_STARVATION,
-    CRASHED_DEADLOCK
-} PlaneState;
-
-// flight type
-typedef enum {
-    DOMESTIC,
-    INTERNATIONAL
-} FlightType;
+#include "lifecycle.h"
+#include "timing.h"
+#include "capacity.h"
+#include "explore.h"
+#include "metrics.h"
+#include "sequencer.h"
+#include "calendar.h"
+#include "perf.h"
 
 // plane (thread)
 typedef struct {
@@ -43,14 +33,18 @@ typedef struct {
     time_t      created_at;
     time_t      waiting_since;
     time_t      finished_at;
+    time_t      fuel_deadline;          // holding fuel runs out, the plane has to divert
+    struct timespec arrived_at;         // monotonic, for the time spent holding
     bool        is_in_critical_state;
+    bool        has_thread;
+    bool        has_landed;
+    int         units[N_RESOURCE_TYPES];    // unit from the sequencer or the calendar, -1 if none
 } Plane;
 
 // airport resources
 typedef struct {
-    sem_t           tracks;
-    sem_t           gates;
-    sem_t           tower;
+    sem_t           resources[N_RESOURCE_TYPES];
+    int             capacity[N_RESOURCE_TYPES];
     pthread_mutex_t mutex_common;
     pthread_mutex_t mutex_priority;
     int             waiting_international_flights;
@@ -68,10 +62,27 @@ typedef struct {
     double  average_operation_time;
     int     maximum_simultaneous_planes;
     int     active_planes;
+    int     planes_held;
+    int     planes_admitted;
+    int     planes_diverted;
+    int     planes_diverted_by_fuel;
+    int     maximum_holding_planes;
+    double  total_holding_time;
 } Statistics;
 
+// holding pattern, planes waiting for admission without a thread
+typedef struct {
+    int            *queue;          // binary heap of plane ids, least fuel on top
+    int             length;
+    int             approaching;    // admitted, not landed yet
+    int             active;         // admitted, still in the airport
+    pthread_mutex_t mutex;
+    pthread_cond_t  capacity_freed;
+} Holding;
+
 // global vars
 Airport airport;
+Holding holding;
 Statistics statistics = {0};
 Plane *planes;
 int simulation_is_active = 1;
@@ -81,19 +92,25 @@ pthread_mutex_t mutex_planes = PTHREAD_MUTEX_INITIALIZER;
 
 // utils
 int potential_deadlock_detected(int plane_id);
-// landing
-int try_international_landing(int plane_id);
-int try_domestic_landing(int plane_id);
-// disembark
-int try_international_disembark(int plane_id);
-int try_domestic_disembark(int plane_id);
-// takeoff
-int try_international_takeoff(int plane_id);
-int try_domestic_takeoff(int plane_id);
+void set_plane_state(int plane_id, PlaneState state);
+// lifecycle phases
+int wait_for_priority(int plane_id, const Phase *phase);
+int acquire_resource(int plane_id, const Phase *phase, ResourceType resource);
+void release_resource(int plane_id, ResourceType resource);
+void release_resources(int plane_id, const PhaseClass *class, int n);
+int run_phase(int plane_id, const Phase *phase);
 // main plane thread
 void *plane_thread(void* arg);
 // continuously spawn planes
 void *spawn_planes(void* arg);
+int start_plane_thread(int plane_id);
+// admission control
+void open_holding_pattern();
+void hold_plane(int plane_id);
+void divert_plane(int plane_id, const char *reason);
+void *admission_controller(void* arg);
+void admission_landed(int plane_id);
+void admission_left(int plane_id);
 // final report
 void print_final_report();
 void open_airport();
@@ -105,8 +122,104 @@ void cleanup();
 void sigint_handler(int sig);
 // logging
 void print_log(int plane_id, const char* operation, const char* details);
+// command line
+void print_usage(const char *program);
+
+int main(int argc, char *argv[]) {
+    bool capacity_search = false;
+    bool schedule_exploration = false;
+    const AirportParameters *airport_profile = &AIRPORT;
+    CapacitySLA sla = { CAPACITY_ARRIVAL_RATE, CAPACITY_MAX_P99_WAIT, CAPACITY_MAX_CRASHES };
+    ExploreOptions exploration = {
+        EXPLORE_STRATEGY, EXPLORE_SCHEDULES, EXPLORE_MIN_PLANES, EXPLORE_MAX_PLANES,
+        EXPLORE_DEPTH, EXPLORE_INTERNATIONAL_PERCENT, -1, EXPLORE_SEED, false, NULL
+    };
+
+    static const struct option options[] = {
+        { "capacity",   no_argument,        NULL, 'c' },
+        { "airport",    required_argument,  NULL, 'a' },
+        { "rate",       required_argument,  NULL, 'r' },
+        { "p99",        required_argument,  NULL, 'p' },
+        { "crashes",    required_argument,  NULL, 'x' },
+        { "explore",    no_argument,        NULL, 'e' },
+        { "strategy",   required_argument,  NULL, 'S' },
+        { "schedules",  required_argument,  NULL, 'n' },
+        { "planes",     required_argument,  NULL, 'P' },
+        { "depth",      required_argument,  NULL, 'd' },
+        { "seed",       required_argument,  NULL, 's' },
+        { "replay",     optional_argument,  NULL, 'R' },
+        { "help",       no_argument,        NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "ca:r:p:x:eS:n:P:d:s:R::h", options, NULL)) != -1) {
+        switch (option) {
+            case 'c':
+                capacity_search = true;
+                break;
+            case 'a': {
+                int index = atoi(optarg);
+                if (index < 0 || index >= NUM_AIRPORTS) {
+                    fprintf(stderr, "--> aeroporto inválido: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                airport_profile = &AIRPORTS[index];
+                exploration.international_percentage = airport_profile->international_flights_percentage;
+                exploration.airport = index;
+                break;
+            }
+            case 'r':
+                sla.arrival_rate = atof(optarg);
+                break;
+            case 'p':
+                sla.max_p99_wait = atof(optarg);
+                break;
+            case 'x':
+                sla.max_crashes = atoi(optarg);
+                break;
+            case 'e':
+                schedule_exploration = true;
+                break;
+            case 'S':
+                if (strcmp(optarg, "pct") == 0) exploration.strategy = EXPLORE_PCT;
+                else if (strcmp(optarg, "random") == 0) exploration.strategy = EXPLORE_RANDOM;
+                else if (strcmp(optarg, "dfs") == 0) exploration.strategy = EXPLORE_DFS;
+                else {
+                    fprintf(stderr, "--> estratégia inválida: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'n':
+                exploration.schedules = atoi(optarg);
+                break;
+            case 'P':
+                exploration.min_planes = exploration.max_planes = atoi(optarg);
+                break;
+            case 'd':
+                exploration.depth = atoi(optarg);
+                break;
+            case 's':
+                exploration.seed = (unsigned)strtoul(optarg, NULL, 10);
+                break;
+            case 'R':
+                exploration.replay = true;
+                exploration.choices = optarg;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (sla.arrival_rate <= 0) {
+        fprintf(stderr, "--> taxa de chegada deve ser positiva\n");
+        return 1;
+    }
 
-int main() {
     // TODO: colors!!
     printf("            :::   :::       :::     :::::::::   ::::::::   ::::::::  :::        ::::::::::: ::::::::    \n");
     printf("      :+:+: :+:+:    :+: :+:   :+:    :+: :+:    :+: :+:    :+: :+:            :+:    :+:    :+:        \n");
@@ -119,6 +232,16 @@ int main() {
     printf("              M  A  R  G  O  L  I  S\n\n");
     printf("                                                    by Guilherme Ganassini && Gustavo Domenech\n");
     
+    if (capacity_search) {
+        printf("\n");
+        return run_capacity_search(airport_profile, &sla) > 0 ? 0 : 2;
+    }
+    if (schedule_exploration) {
+        printf("\n");
+        int failures = run_schedule_exploration(&exploration);
+        return (failures < 0) ? 1 : (failures > 0) ? 3 : 0;
+    }
+
     // allocate the planes array
     planes = (Plane*)malloc(MAX_N_PLANES * sizeof(Plane));
     if (planes == NULL) {
@@ -133,6 +256,22 @@ int main() {
     
     open_airport();
     simulation_start = time(NULL);
+    if (METRICS_ENABLED) {
+        metrics_start(simulation_start);
+    }
+    if (PERF_COUNTERS_ENABLED) {
+        perf_open();
+    }
+    
+    // this thread admits held planes as the airport frees up
+    pthread_t controller_thread;
+    if (ADMISSION_CONTROL) {
+        open_holding_pattern();
+        if (pthread_create(&controller_thread, NULL, admission_controller, NULL) != 0) {
+            perror("--> falha ao criar thread de controle de admissão");
+            exit(1);
+        }
+    }
     
     // this thread keeps generates planes after a random interval 
     pthread_t generator_thread;
@@ -150,10 +289,11 @@ int main() {
         // show status every 30 seconds
         if ((time(NULL) - simulation_start) % 30 == 0) {
             // TODO: colors here would be very nice
-            printf("\n[STATUS] tempo: %lds | aviões %d criados | %d ativos | %d finalizados |\n\n", 
+            printf("\n[STATUS] tempo: %lds | aviões %d criados | %d ativos | %d em espera | %d finalizados |\n\n", 
                    time(NULL) - simulation_start,
                    statistics.total_managed_planes,
                    statistics.active_planes,
+                   holding.length,
                    statistics.successfully_managed_planes);
         }
     }
@@ -164,6 +304,10 @@ int main() {
     
 
     pthread_join(generator_thread, NULL);
+    if (ADMISSION_CONTROL) {
+        // the controller returns once the holding pattern is empty
+        pthread_join(controller_thread, NULL);
+    }
     
     // TODO: colors!!
     printf("--> esperando operações de vôo terminarem...\n");
@@ -176,6 +320,8 @@ int main() {
             break;
         }
         
+        if (!planes[i].has_thread) continue;
+        
         void* result_thread;
         struct timespec timeout_spec;
         timeout_spec.tv_sec = 2; // 2 seconds
@@ -190,8 +336,16 @@ int main() {
     
     printf("--> todas as operações finalizadas.\n\n");
     
+    PerfSample report_sample;
+    perf_begin(&report_sample);
     print_final_report();
+    perf_end(PERF_REPORTING, &report_sample);
+    if (PERF_COUNTERS_ENABLED) {
+        perf_print_report(statistics.successfully_managed_planes);
+        perf_write(PERF_OUTPUT_PATH, statistics.successfully_managed_planes);
+    }
     
+    metrics_stop();
     cleanup();
     
     printf("\n--> simulação finalizada\n");
@@ -199,13 +353,11 @@ int main() {
     return 0;
 }
 
-// landing operations
-int 
-try_domestic_landing(int plane_id) 
+// waits while international flights are active; 0 once clear, -1 on starvation crash.
+// only phases that mark the critical state count it as a starvation case
+int
+wait_for_priority(int plane_id, const Phase *phase)
 {
-    print_log(plane_id, "POUSO", "solicitando torre");
-    
-    // check for international flights priority
     pthread_mutex_lock(&airport.mutex_priority);
     while (airport.waiting_international_flights > 0) {
         pthread_mutex_unlock(&airport.mutex_priority);
@@ -219,7 +371,8 @@ try_domestic_landing(int plane_id)
             // TODO: colors!!
             print_log(plane_id, "STARVATION", "avião caiu após 90s de espera");
             return -1; // starvation crash
-        } else if (waiting_time > TIME_TILL_CRITICAL_STATE && !planes[plane_id].is_in_critical_state) {
+        } else if (phase->marks_critical_state && waiting_time > TIME_TILL_CRITICAL_STATE
+                   && !planes[plane_id].is_in_critical_state) {
             print_log(plane_id, "STARVATION", "state crítico - 60s de espera");
             planes[plane_id].is_in_critical_state = 1;
             pthread_mutex_lock(&mutex_statistics);
@@ -230,241 +383,134 @@ try_domestic_landing(int plane_id)
         pthread_mutex_lock(&airport.mutex_priority);
     }
     pthread_mutex_unlock(&airport.mutex_priority);
-    
-    // tower -> track
-    if (sem_wait(&airport.tower) != 0) return 0;
-    
-    print_log(plane_id, "POUSO", "torre adquirida, solicitando pista");
-    
-    if (potential_deadlock_detected(plane_id)) {
-        print_log(plane_id, "DEADLOCK", "detectado durante pouso");
-        sem_post(&airport.tower);
-        return 0;
-    }
-    
-    if (sem_wait(&airport.tracks) != 0) {
-        sem_post(&airport.tower);
-        return 0;
-    }
-    
-    print_log(plane_id, "POUSO", "recursos adquiridos, iniciando pouso");
-    planes[plane_id].state = DURING_LANDING;
-    
-    // simulate landing duration
-    usleep(500000 + rand() % 1000000);
-    
-    // release resources
-    sem_post(&airport.tracks);
-    sem_post(&airport.tower);
-    
-    print_log(plane_id, "POUSO", "concluído com sucesso");
-    return 1;
+    return 0;
 }
 
+// takes one unit of a resource: runways through the sequencer, runways and gates
+// through the reservation calendar, everything else from its semaphore
 int
-try_international_landing(int plane_id) 
+acquire_resource(int plane_id, const Phase *phase, ResourceType resource)
 {
-    print_log(plane_id, "POUSO", "solicitando pista");
-    
-    // track -> tower
-    if (sem_wait(&airport.tracks) != 0) return 0;
-    
-    print_log(plane_id, "POUSO", "pista adquirida, solicitando torre");
-    
-    // check for deadlock
-    if (potential_deadlock_detected(plane_id)) {
-        print_log(plane_id, "DEADLOCK", "detectado durante pouso");
-        sem_post(&airport.tracks);
-        return 0;
+    bool reserved = RESERVATIONS_ENABLED && calendar_books(resource);
+    int *unit = &planes[plane_id].units[resource];
+    struct timespec requested;
+    
+    clock_gettime(CLOCK_MONOTONIC, &requested);
+    if (SEQUENCER_ENABLED && resource == RESOURCE_TRACK) {
+        *unit = sequencer_acquire(plane_id, planes[plane_id].type, phase - PHASES);
+    } else if (reserved) {
+        *unit = calendar_acquire(plane_id, phase - PHASES, resource);
+    } else {
+        return sem_wait(&airport.resources[resource]);
     }
     
-    if (sem_wait(&airport.tower) != 0) {
-        sem_post(&airport.tracks);
-        return 0;
+    if (reserved) {
+        calendar_observe(plane_id, phase - PHASES, resource, *unit, seconds_since(&requested));
     }
-    
-    print_log(plane_id, "POUSO", "recursos adquiridos, iniciando pouso");
-    planes[plane_id].state = DURING_LANDING;
-    
-    // simulates landing duration
-    usleep(500000 + rand() % 1000000); // 0.5 to 1.5 seconds
-    
-    // release resources
-    sem_post(&airport.tracks);
-    sem_post(&airport.tower);
-    
-    print_log(plane_id, "POUSO", "concluído com sucesso");
-    return 1;
+    return 0;
 }
 
-// disembark operations
-int
-try_international_disembark(int plane_id)
+void
+release_resource(int plane_id, ResourceType resource)
 {
-    print_log(plane_id, "DESEMBARQUE", "Solicitando portão");
-    
-    // gate -> tower
-    if (sem_wait(&airport.gates) != 0) return 0;
+    int *unit = &planes[plane_id].units[resource];
     
-    print_log(plane_id, "DESEMBARQUE", "Portão adquirido, solicitando torre");
-    
-    if (sem_wait(&airport.tower) != 0) {
-        sem_post(&airport.gates);
-        return 0;
+    if (RESERVATIONS_ENABLED && calendar_books(resource)) {
+        calendar_release(plane_id, resource, *unit);
     }
-    
-    print_log(plane_id, "DESEMBARQUE", "Recursos adquiridos - iniciando desembarque");
-    planes[plane_id].state = DURING_DISEMBARK;
-    
-    // simulates disembark duration
-    usleep(1000000 + rand() % 2000000); // 1 to 3 seconds
-    
-    // release the tower first
-    sem_post(&airport.tower);
-    
-    // keep gate for longer
-    usleep(500000);
-    sem_post(&airport.gates);
-    
-    print_log(plane_id, "DESEMBARQUE", "Concluído com sucesso");
-    return 1;
+    if (SEQUENCER_ENABLED && resource == RESOURCE_TRACK) {
+        sequencer_release(*unit);
+    } else if (*unit < 0) {
+        sem_post(&airport.resources[resource]);
+    }
+    *unit = -1;
+    metrics_add(&metrics.resources_in_use[resource], -1);
 }
 
-int
-try_domestic_disembark(int plane_id)
+// releases the first 'n' resources of a class, last acquired first
+void
+release_resources(int plane_id, const PhaseClass *class, int n)
 {
-    print_log(plane_id, "DESEMBARQUE", "solicitando torre");
-    
-    // check priority
-    pthread_mutex_lock(&airport.mutex_priority);
-    while (airport.waiting_international_flights > 0) {
-        pthread_mutex_unlock(&airport.mutex_priority);
-        usleep(100000);
-        
-        time_t now = time(NULL);
-        int waiting_time = now - planes[plane_id].waiting_since;
-        
-        if (waiting_time > TIME_TILL_CRASH) {
-            print_log(plane_id, "STARVATION", "avião caiu após 90s de espera");
-            return -1;
-        }
-        
-        pthread_mutex_lock(&airport.mutex_priority);
-    }
-    pthread_mutex_unlock(&airport.mutex_priority);
-    
-    // tower -> gate
-    if (sem_wait(&airport.tower) != 0) return 0;
-    
-    print_log(plane_id, "DESEMBARQUE", "torre adquirida, solicitando portão");
-    
-    if (sem_wait(&airport.gates) != 0) {
-        sem_post(&airport.tower);
-        return 0;
+    for (int i = n - 1; i >= 0; i--) {
+        release_resource(plane_id, class->order[i]);
     }
-    
-    print_log(plane_id, "DESEMBARQUE", "recursos adquiridos, iniciando desembarque");
-    planes[plane_id].state = DURING_DISEMBARK;
-    
-    usleep(1000000 + rand() % 2000000);
-    
-    sem_post(&airport.tower);
-    usleep(500000);
-    sem_post(&airport.gates);
-    
-    print_log(plane_id, "DESEMBARQUE", "concluído com sucesso");
-    return 1;
 }
 
-// takeoff
-int 
-try_international_takeoff(int plane_id)
+// runs one lifecycle phase: 1 on success, 0 on deadlock, -1 on starvation
+int
+run_phase(int plane_id, const Phase *phase)
 {
-    print_log(plane_id, "DECOLAGEM", "Solicitando portão");
+    const PhaseClass *class = &phase->classes[planes[plane_id].type];
+    int64_t *waiting = &metrics.waiting_by_type[planes[plane_id].type];
+    struct timespec requested;
+    char details[128];
     
-    // gate -> track -> tower
-    if (sem_wait(&airport.gates) != 0) return 0;
-    
-    print_log(plane_id, "DECOLAGEM", "portão adquirido, solicitando pista");
+    set_plane_state(plane_id, phase->waiting_state);
+    planes[plane_id].waiting_since = time(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &requested);
     
-    if (sem_wait(&airport.tracks) != 0) {
-        sem_post(&airport.gates);
-        return 0;
+    // phases without resources only take time
+    if (class->n_resources == 0) {
+        usleep(phase->min_usec + rand() % (phase->max_usec - phase->min_usec));
+        return 1;
     }
     
-    print_log(plane_id, "DECOLAGEM", "pista adquirida, solicitando torre");
+    snprintf(details, sizeof(details), "solicitando %s", RESOURCES[class->order[0]].name);
+    print_log(plane_id, phase->log_name, details);
+    metrics_add(waiting, 1);
     
-    if (sem_wait(&airport.tower) != 0) {
-        sem_post(&airport.tracks);
-        sem_post(&airport.gates);
-        return 0;
+    if (RESERVATIONS_ENABLED) {
+        calendar_checkin(plane_id, phase - PHASES);
     }
     
-    print_log(plane_id, "DECOLAGEM", "recursos adquiridos, iniciando decolagem");
-    planes[plane_id].state = DURING_TAKEOFF;
-    
-    usleep(800000 + rand() % 1200000); // 0.8 to 2 seconds
-    
-    // release the resources
-    sem_post(&airport.tower);
-    sem_post(&airport.tracks);
-    sem_post(&airport.gates);
-    
-    print_log(plane_id, "DECOLAGEM", "concluída com sucesso");
-    return 1;
-}
-
-int
-try_domestic_takeoff(int plane_id)
-{
-    print_log(plane_id, "DECOLAGEM", "solicitando torre");
+    if (class->yields_to_international && wait_for_priority(plane_id, phase) != 0) {
+        metrics_add(waiting, -1);
+        return -1;
+    }
     
-    // check priority
-    pthread_mutex_lock(&airport.mutex_priority);
-    while (airport.waiting_international_flights > 0) {
-        pthread_mutex_unlock(&airport.mutex_priority);
-        usleep(100000);
+    for (int i = 0; i < class->n_resources; i++) {
+        if (acquire_resource(plane_id, phase, class->order[i]) != 0) {
+            release_resources(plane_id, class, i);
+            metrics_add(waiting, -1);
+            return 0;
+        }
+        metrics_add(&metrics.resources_in_use[class->order[i]], 1);
+        if (i + 1 == class->n_resources) break;
         
-        time_t now = time(NULL);
-        int waiting_time = now - planes[plane_id].waiting_since;
+        snprintf(details, sizeof(details), "%s, solicitando %s",
+                 RESOURCES[class->order[i]].acquired, RESOURCES[class->order[i + 1]].name);
+        print_log(plane_id, phase->log_name, details);
         
-        if (waiting_time > TIME_TILL_CRASH) {
-            print_log(plane_id, "STARVATION", "avião caiu após 90s de espera");
-            return -1;
+        if (phase->checks_deadlock && potential_deadlock_detected(plane_id)) {
+            snprintf(details, sizeof(details), "detectado durante %s", phase->action);
+            print_log(plane_id, "DEADLOCK", details);
+            release_resources(plane_id, class, i + 1);
+            metrics_add(waiting, -1);
+            return 0;
         }
-        
-        pthread_mutex_lock(&airport.mutex_priority);
     }
-    pthread_mutex_unlock(&airport.mutex_priority);
     
-    // tower -> gate -> track
-    if (sem_wait(&airport.tower) != 0) return 0;
+    metrics_add(waiting, -1);
+    metrics_observe_wait(phase - PHASES, seconds_since(&requested));
     
-    print_log(plane_id, "DECOLAGEM", "torre adquirida, solicitando portão");
-    
-    if (sem_wait(&airport.gates) != 0) {
-        sem_post(&airport.tower);
-        return 0;
-    }
+    snprintf(details, sizeof(details), "recursos adquiridos, iniciando %s", phase->action);
+    print_log(plane_id, phase->log_name, details);
+    set_plane_state(plane_id, phase->active_state);
     
-    print_log(plane_id, "DECOLAGEM", "portão adquirido, solicitando pista");
+    // simulate the phase duration
+    usleep(phase->min_usec + rand() % (phase->max_usec - phase->min_usec));
     
-    if (sem_wait(&airport.tracks) != 0) {
-        sem_post(&airport.gates);
-        sem_post(&airport.tower);
-        return 0;
+    // release resources, keeping the held one a little longer
+    for (int i = class->n_resources - 1; i >= 0; i--) {
+        if (phase->hold_usec > 0 && class->order[i] == phase->held) continue;
+        release_resource(plane_id, class->order[i]);
+    }
+    if (phase->hold_usec > 0) {
+        usleep(phase->hold_usec);
+        release_resource(plane_id, phase->held);
     }
     
-    print_log(plane_id, "DECOLAGEM", "recursos adquiridos, iniciando decolagem");
-    planes[plane_id].state = DURING_TAKEOFF;
-    
-    usleep(800000 + rand() % 1200000);
-    
-    sem_post(&airport.tower);
-    sem_post(&airport.tracks);
-    sem_post(&airport.gates);
-    
-    print_log(plane_id, "DECOLAGEM", "concluída com sucesso");
+    print_log(plane_id, phase->log_name, phase->done);
     return 1;
 }
 
@@ -491,64 +537,30 @@ plane_thread(void* arg)
     
     print_log(plane_id, "INICIO", "avião chegando ao aeroporto");
     
-    // OPERATION: Landing
-    planes[plane_id].state = WAITING_FOR_LANDING;
-    planes[plane_id].waiting_since = time(NULL);
-    
-    if (planes[plane_id].type == INTERNATIONAL) {
-        result = try_international_landing(plane_id);
-    } else {
-        result = try_domestic_landing(plane_id);
-    }
-    
-    if (result == -1) {
-        planes[plane_id].state = CRASHED_STARVATION;
-        goto finalizacao;
-    } else if (result == 0) {
-        planes[plane_id].state = CRASHED_DEADLOCK;
-        goto finalizacao;
-    }
-    
-    // OPERAÇÃO: Disembark
-    planes[plane_id].state = WAITING_FOR_GATE;
-    planes[plane_id].waiting_since = time(NULL);
-    
-    if (planes[plane_id].type == INTERNATIONAL) {
-        result = try_international_disembark(plane_id);
-    } else {
-        result = try_domestic_disembark(plane_id);
-    }
-    
-    if (result == -1) {
-        planes[plane_id].state = CRASHED_STARVATION;
-        goto finalizacao;
-    } else if (result == 0) {
-        planes[plane_id].state = CRASHED_DEADLOCK;
-        goto finalizacao;
-    }
-    
-    // waits for takeoff
-    planes[plane_id].state = WAITING_FOR_TAKEOFF;
-    usleep(2000000 + rand() % 3000000); // Espera entre 2-5 segundos
-    
-    // OPERATION: Takeoff
-    planes[plane_id].waiting_since = time(NULL);
-    
-    if (planes[plane_id].type == INTERNATIONAL) {
-        result = try_international_takeoff(plane_id);
-    } else {
-        result = try_domestic_takeoff(plane_id);
-    }
-    
-    if (result == -1) {
-        planes[plane_id].state = CRASHED_STARVATION;
-        goto finalizacao;
-    } else if (result == 0) {
-        planes[plane_id].state = CRASHED_DEADLOCK;
-        goto finalizacao;
+    // run the lifecycle phases in order
+    for (int p = 0; p < N_PHASES; p++) {
+        if (!phase_enabled(&PHASES[p], airport.capacity)) continue;
+        
+        PerfSample sample;
+        perf_begin(&sample);
+        result = run_phase(plane_id, &PHASES[p]);
+        perf_end(PERF_PHASE(p), &sample);
+        
+        if (result == -1) {
+            set_plane_state(plane_id, CRASHED_STARVATION);
+            goto finalizacao;
+        } else if (result == 0) {
+            set_plane_state(plane_id, CRASHED_DEADLOCK);
+            goto finalizacao;
+        }
+        
+        // the first phase brings the plane to the ground
+        if (p == 0 && ADMISSION_CONTROL) {
+            admission_landed(plane_id);
+        }
     }
     
-    planes[plane_id].state = FINISHED;
+    set_plane_state(plane_id, FINISHED);
     print_log(plane_id, "SUCESSO", "operações concluídas com sucesso");
 
 finalizacao:
@@ -566,19 +578,27 @@ finalizacao:
     switch(planes[plane_id].state) {
         case FINISHED:
             statistics.successfully_managed_planes++;
+            metrics_add(&metrics.planes_finished, 1);
             break;
         case CRASHED_STARVATION:
             statistics.planes_crashed_by_starvation++;
+            metrics_add(&metrics.planes_crashed_by_starvation, 1);
             break;
         case CRASHED_DEADLOCK:
             statistics.planes_crashed_by_deadlock++;
             statistics.deadlocks_detected++;
+            metrics_add(&metrics.planes_crashed_by_deadlock, 1);
             break;
         default:
             break;
     }
     pthread_mutex_unlock(&mutex_statistics);
     
+    if (ADMISSION_CONTROL) {
+        admission_left(plane_id);
+    }
+    
+    perf_thread_exit();
     return NULL;
 }
 
@@ -589,6 +609,9 @@ spawn_planes(void* arg)
     int plane_counter = 0;
     
     while (simulation_is_active && plane_counter < MAX_N_PLANES) {
+        PerfSample sample;
+        perf_begin(&sample);
+        
         // lock the planes array mutex so no other thread modifies it
         pthread_mutex_lock(&mutex_planes);
         
@@ -596,12 +619,21 @@ spawn_planes(void* arg)
         planes[plane_counter].id = plane_counter;
         planes[plane_counter].type = (rand() % 100 < AIRPORT.international_flights_percentage) ? INTERNATIONAL : DOMESTIC;
         planes[plane_counter].state = WAITING_FOR_LANDING;
+        metrics_add(&metrics.planes_created, 1);
+        metrics_add(&metrics.planes_by_state[WAITING_FOR_LANDING], 1);
         planes[plane_counter].created_at = time(NULL);
+        clock_gettime(CLOCK_MONOTONIC, &planes[plane_counter].arrived_at);
+        planes[plane_counter].fuel_deadline = planes[plane_counter].created_at + HOLDING_MIN_FUEL
+                                            + rand() % (HOLDING_MAX_FUEL - HOLDING_MIN_FUEL + 1);
         planes[plane_counter].is_in_critical_state = 0;
+        planes[plane_counter].has_thread = 0;
+        planes[plane_counter].has_landed = 0;
+        for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+            planes[plane_counter].units[r] = -1;
+        }
         
-        // create plane thread
-        if (pthread_create(&planes[plane_counter].thread_id, NULL, plane_thread, &planes[plane_counter].id) != 0) {
-            perror("Erro ao criar thread do avião");
+        // create plane thread, or leave it holding until the controller admits it
+        if (!ADMISSION_CONTROL && start_plane_thread(plane_counter) != 0) {
             pthread_mutex_unlock(&mutex_planes);
             break;
         }
@@ -614,16 +646,248 @@ spawn_planes(void* arg)
                     (planes[plane_counter].type == INTERNATIONAL) ? 
                     "Voo internacional criado" : "Voo doméstico criado");
         
+        if (ADMISSION_CONTROL) {
+            hold_plane(plane_counter);
+        }
+        
         plane_counter++;
         pthread_mutex_unlock(&mutex_planes);
+        perf_end(PERF_SPAWN, &sample);
         
         // random interval between creating planes
         usleep((1 + rand() % 10) * 1000000);
     }
     
+    perf_thread_exit();
     return NULL;
 }
 
+// create the plane thread
+int
+start_plane_thread(int plane_id)
+{
+    if (RESERVATIONS_ENABLED) {
+        calendar_book(plane_id, planes[plane_id].type);
+    }
+    if (pthread_create(&planes[plane_id].thread_id, NULL, plane_thread, &planes[plane_id].id) != 0) {
+        perror("Erro ao criar thread do avião");
+        return -1;
+    }
+    planes[plane_id].has_thread = 1;
+    return 0;
+}
+
+// admission control
+void open_holding_pattern() {
+    holding.queue = (int*)malloc(HOLDING_QUEUE_SIZE * sizeof(int));
+    if (holding.queue == NULL) {
+        perror("--> failed to allocate memory for holding pattern");
+        exit(1);
+    }
+    holding.length = 0;
+    holding.approaching = 0;
+    holding.active = 0;
+    pthread_mutex_init(&holding.mutex, NULL);
+    pthread_cond_init(&holding.capacity_freed, NULL);
+}
+
+// less fuel left goes first, then whoever arrived first
+static bool
+more_urgent(int a, int b)
+{
+    if (planes[a].fuel_deadline != planes[b].fuel_deadline) {
+        return planes[a].fuel_deadline < planes[b].fuel_deadline;
+    }
+    return planes[a].created_at < planes[b].created_at
+        || (planes[a].created_at == planes[b].created_at && a < b);
+}
+
+static void
+holding_sift_up(int i)
+{
+    while (i > 0 && more_urgent(holding.queue[i], holding.queue[(i - 1) / 2])) {
+        int parent = (i - 1) / 2;
+        int swap = holding.queue[i];
+        holding.queue[i] = holding.queue[parent];
+        holding.queue[parent] = swap;
+        i = parent;
+    }
+}
+
+static void
+holding_sift_down(int i)
+{
+    for (;;) {
+        int most = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < holding.length && more_urgent(holding.queue[left], holding.queue[most])) most = left;
+        if (right < holding.length && more_urgent(holding.queue[right], holding.queue[most])) most = right;
+        if (most == i) break;
+        int swap = holding.queue[i];
+        holding.queue[i] = holding.queue[most];
+        holding.queue[most] = swap;
+        i = most;
+    }
+}
+
+// removes the entry at 'i' and returns its plane id (holding.mutex held)
+static int
+holding_remove(int i)
+{
+    int plane_id = holding.queue[i];
+    holding.queue[i] = holding.queue[--holding.length];
+    if (i < holding.length) {
+        holding_sift_up(i);
+        holding_sift_down(i);
+    }
+    return plane_id;
+}
+
+// puts an arriving plane in the holding pattern, diverting one if it is full
+void
+hold_plane(int plane_id)
+{
+    pthread_mutex_lock(&holding.mutex);
+    
+    // the admission controller is gone once the simulation ends
+    if (!simulation_is_active) {
+        divert_plane(plane_id, "simulação encerrada, desviado para alternativa");
+        pthread_mutex_unlock(&holding.mutex);
+        return;
+    }
+    
+    if (holding.length == HOLDING_QUEUE_SIZE) {
+        int least_urgent = -1;
+        if (HOLDING_POLICY == DIVERT_MOST_FUEL) {
+            // the least urgent entry is one of the heap leaves
+            for (int i = holding.length / 2; i < holding.length; i++) {
+                if (least_urgent == -1 || more_urgent(holding.queue[least_urgent], holding.queue[i])) {
+                    least_urgent = i;
+                }
+            }
+        }
+        if (least_urgent == -1 || more_urgent(holding.queue[least_urgent], plane_id)) {
+            divert_plane(plane_id, "espera cheia, desviado para alternativa");
+            pthread_mutex_unlock(&holding.mutex);
+            return;
+        }
+        divert_plane(holding_remove(least_urgent), "espera cheia, desviado para alternativa");
+    }
+    
+    set_plane_state(plane_id, HOLDING);
+    holding.queue[holding.length++] = plane_id;
+    holding_sift_up(holding.length - 1);
+    metrics_set(&metrics.holding, holding.length);
+    
+    pthread_mutex_lock(&mutex_statistics);
+    statistics.planes_held++;
+    if (holding.length > statistics.maximum_holding_planes) {
+        statistics.maximum_holding_planes = holding.length;
+    }
+    pthread_mutex_unlock(&mutex_statistics);
+    
+    print_log(plane_id, "ESPERA", "entrando no circuito de espera");
+    pthread_cond_signal(&holding.capacity_freed);
+    pthread_mutex_unlock(&holding.mutex);
+}
+
+void
+divert_plane(int plane_id, const char *reason)
+{
+    bool out_of_fuel = planes[plane_id].state == HOLDING && time(NULL) >= planes[plane_id].fuel_deadline;
+    
+    set_plane_state(plane_id, DIVERTED);
+    planes[plane_id].finished_at = time(NULL);
+    metrics_add(&metrics.planes_diverted, 1);
+    
+    pthread_mutex_lock(&mutex_statistics);
+    statistics.planes_diverted++;
+    if (out_of_fuel) {
+        statistics.planes_diverted_by_fuel++;
+    }
+    pthread_mutex_unlock(&mutex_statistics);
+    
+    print_log(plane_id, "DESVIO", reason);
+}
+
+// admits held planes as approach and airport capacity frees up
+void*
+admission_controller(void* arg)
+{
+    (void)arg;
+    
+    pthread_mutex_lock(&holding.mutex);
+    for (;;) {
+        time_t now = time(NULL);
+        
+        // planes out of holding fuel leave for their alternate
+        for (int i = 0; i < holding.length; i++) {
+            if (planes[holding.queue[i]].fuel_deadline <= now) {
+                divert_plane(holding_remove(i), "sem combustível para espera, desviado para alternativa");
+                i--;
+            }
+        }
+        
+        // nobody is admitted after the end of the simulation, so shutdown stays bounded
+        if (!simulation_is_active) {
+            while (holding.length > 0) {
+                divert_plane(holding_remove(holding.length - 1), "simulação encerrada, desviado para alternativa");
+            }
+            metrics_set(&metrics.holding, 0);
+            break;
+        }
+        
+        while (holding.length > 0
+               && holding.approaching < ADMISSION_MAX_APPROACHING
+               && holding.active < ADMISSION_MAX_ACTIVE) {
+            int plane_id = holding_remove(0);
+            
+            set_plane_state(plane_id, WAITING_FOR_LANDING);
+            if (start_plane_thread(plane_id) != 0) {
+                divert_plane(plane_id, "falha ao admitir, desviado para alternativa");
+                continue;
+            }
+            holding.approaching++;
+            holding.active++;
+            
+            pthread_mutex_lock(&mutex_statistics);
+            statistics.planes_admitted++;
+            statistics.total_holding_time += seconds_since(&planes[plane_id].arrived_at);
+            pthread_mutex_unlock(&mutex_statistics);
+        }
+        
+        metrics_set(&metrics.holding, holding.length);
+        
+        // wake up on freed capacity, or every 100ms to check fuel
+        timed_wait_ms(&holding.capacity_freed, &holding.mutex, 100);
+    }
+    pthread_mutex_unlock(&holding.mutex);
+    
+    return NULL;
+}
+
+void
+admission_landed(int plane_id)
+{
+    pthread_mutex_lock(&holding.mutex);
+    planes[plane_id].has_landed = 1;
+    holding.approaching--;
+    pthread_cond_signal(&holding.capacity_freed);
+    pthread_mutex_unlock(&holding.mutex);
+}
+
+void
+admission_left(int plane_id)
+{
+    pthread_mutex_lock(&holding.mutex);
+    if (!planes[plane_id].has_landed) {
+        holding.approaching--;
+    }
+    holding.active--;
+    pthread_cond_signal(&holding.capacity_freed);
+    pthread_mutex_unlock(&holding.mutex);
+}
+
 // final report
 void print_final_report() {
     // # TODO: colors
@@ -638,6 +902,24 @@ void print_final_report() {
     printf("  máximo de aviões simultâneos: %d\n",      statistics.maximum_simultaneous_planes);
     printf("  aviões ainda ativos: %d\n",               statistics.active_planes);
     
+    if (ADMISSION_CONTROL) {
+        printf("\n--> CONTROLE DE ADMISSÃO:\n");
+        printf("  aviões em espera: %d\n",                 statistics.planes_held);
+        printf("  máximo de aviões em espera: %d\n",       statistics.maximum_holding_planes);
+        printf("  aviões admitidos: %d\n",                 statistics.planes_admitted);
+        printf("  tempo médio de espera até a admissão: %.2fs\n",
+               (statistics.planes_admitted > 0) ? statistics.total_holding_time / statistics.planes_admitted : 0.0);
+        printf("  aviões desviados: %d\n",                 statistics.planes_diverted);
+        printf("    por falta de combustível: %d\n",       statistics.planes_diverted_by_fuel);
+    }
+    
+    if (SEQUENCER_ENABLED) {
+        sequencer_print_report();
+    }
+    if (RESERVATIONS_ENABLED) {
+        calendar_print_report();
+    }
+    
     printf("\n--> PROBLEMAS:\n");
     printf("  casos de starvation: %d\n",               statistics.starvation_cases);
     printf("  deadlocks detectados: %d\n",              statistics.deadlocks_detected);
@@ -653,7 +935,7 @@ void print_final_report() {
     }
     
     printf("\n--> ESTADO FINAL:\n");
-    int state_counters[10] = {0};
+    int state_counters[N_PLANE_STATES] = {0};
     for (int i = 0; i < statistics.total_managed_planes && i < MAX_N_PLANES; i++) {
         state_counters[planes[i].state]++;
     }
@@ -661,10 +943,22 @@ void print_final_report() {
     printf("  finalizados: %d\n",                   state_counters[FINISHED]);
     printf("  crashed por starvation: %d\n",        state_counters[CRASHED_STARVATION]);
     printf("  crashed por deadlock: %d\n",          state_counters[CRASHED_DEADLOCK]);
+    if (ADMISSION_CONTROL) {
+        printf("  desviados: %d\n",                 state_counters[DIVERTED]);
+        printf("    ainda em espera: %d\n",         state_counters[HOLDING]);
+    }
     printf("    ainda aguardando pouso: %d\n",      state_counters[WAITING_FOR_LANDING]);
     printf("    ainda pousando: %d\n",              state_counters[DURING_LANDING]);
+    if (N_TAXIWAYS > 0) {
+        printf("    ainda aguardando taxiamento: %d\n", state_counters[WAITING_FOR_TAXIWAY]);
+        printf("    ainda taxiando: %d\n",          state_counters[DURING_TAXI]);
+    }
     printf("    ainda aguardando portão: %d\n",     state_counters[WAITING_FOR_GATE]);
     printf("    ainda desembarcando: %d\n",         state_counters[DURING_DISEMBARK]);
+    if (N_FUEL_TRUCKS > 0) {
+        printf("    ainda aguardando combustível: %d\n", state_counters[WAITING_FOR_FUEL]);
+        printf("    ainda abastecendo: %d\n",       state_counters[DURING_REFUEL]);
+    }
     printf("    ainda aguardando decolagem: %d\n",  state_counters[WAITING_FOR_TAKEOFF]);
     printf("    ainda decolando: %d\n",             state_counters[DURING_TAKEOFF]);
     printf("\n*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*\n");
@@ -673,9 +967,21 @@ void print_final_report() {
 // opens the airport
 void open_airport() {
     //  semaphores
-    sem_init(&airport.tracks, 0, N_TRACKS);
-    sem_init(&airport.gates, 0, N_GATES);
-    sem_init(&airport.tower, 0, N_TOWER_MAX_OPERATIONS);
+    airport.capacity[RESOURCE_TRACK] = N_TRACKS;
+    airport.capacity[RESOURCE_GATE] = N_GATES;
+    airport.capacity[RESOURCE_TOWER] = N_TOWER_MAX_OPERATIONS;
+    airport.capacity[RESOURCE_TAXIWAY] = N_TAXIWAYS;
+    airport.capacity[RESOURCE_FUEL_TRUCK] = N_FUEL_TRUCKS;
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        sem_init(&airport.resources[r], 0, airport.capacity[r]);
+        metrics_set(&metrics.resources_capacity[r], airport.capacity[r]);
+    }
+    if (SEQUENCER_ENABLED) {
+        sequencer_open(N_TRACKS, 2 * MAX_N_PLANES);
+    }
+    if (RESERVATIONS_ENABLED) {
+        calendar_open(airport.capacity, MAX_N_PLANES);
+    }
     
     // mutexes
     pthread_mutex_init(&airport.mutex_common, NULL);
@@ -690,6 +996,12 @@ void open_airport() {
     printf("  pistas: %d\n", N_TRACKS);
     printf("  portões: %d\n", N_GATES);
     printf("  capacidade da torre: %d operações simultâneas\n", N_TOWER_MAX_OPERATIONS);
+    if (N_TAXIWAYS > 0) {
+        printf("  pistas de taxiamento: %d\n", N_TAXIWAYS);
+    }
+    if (N_FUEL_TRUCKS > 0) {
+        printf("  caminhões de combustível: %d\n", N_FUEL_TRUCKS);
+    }
     printf("  tempo de simulação: %d segundos\n", SIM_DURATION);
     printf("\n");
 }
@@ -700,13 +1012,24 @@ const char* get_flight_type(FlightType type) {
 }
 // cleanup
 void cleanup() {
-    sem_destroy(&airport.tracks);
-    sem_destroy(&airport.gates);
-    sem_destroy(&airport.tower);
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        sem_destroy(&airport.resources[r]);
+    }
     pthread_mutex_destroy(&airport.mutex_common);
     pthread_mutex_destroy(&airport.mutex_priority);
     pthread_mutex_destroy(&mutex_statistics);
     pthread_mutex_destroy(&mutex_planes);
+    if (SEQUENCER_ENABLED) {
+        sequencer_close();
+    }
+    if (RESERVATIONS_ENABLED) {
+        calendar_close();
+    }
+    if (ADMISSION_CONTROL) {
+        pthread_mutex_destroy(&holding.mutex);
+        pthread_cond_destroy(&holding.capacity_freed);
+        free(holding.queue);
+    }
     free(planes);
 }
 
@@ -714,14 +1037,23 @@ void cleanup() {
 int
 potential_deadlock_detected(int plane_id)
 {
-    // are there resources waiting for more than 30s?
+    // are there resources waiting for more than TIME_TILL_DEADLOCK?
     time_t now = time(NULL);
-    if (now - planes[plane_id].waiting_since > 30) {
+    if (now - planes[plane_id].waiting_since > TIME_TILL_DEADLOCK) {
         return 1;
     }
     return 0;
 }
 
+// every state change goes through here so the metrics gauges follow it
+void
+set_plane_state(int plane_id, PlaneState state)
+{
+    metrics_add(&metrics.planes_by_state[planes[plane_id].state], -1);
+    metrics_add(&metrics.planes_by_state[state], 1);
+    planes[plane_id].state = state;
+}
+
 // handler to stop creating planes (threads)
 void sigint_handler(int sig) {
     // TODO: colors!!
@@ -738,3 +1070,22 @@ void print_log(int plane_id, const char* operation, const char* details) {
            get_flight_type(planes[plane_id].type), operation, details);
     fflush(stdout);
 }
+
+// command line
+void print_usage(const char *program) {
+    printf("uso: %s [--capacity [--airport=N] [--rate=R] [--p99=T] [--crashes=C]]\n", program);
+    printf("       %s [--explore [--airport=N] [--strategy=pct|random|dfs] [--schedules=K] [--planes=N]\n", program);
+    printf("                  [--depth=D] [--seed=S] [--replay[=C1,C2,...]]]\n");
+    printf("  --capacity     busca as configurações mínimas de pistas, portões e torre\n");
+    printf("  --airport=N    perfil de aeroporto (índice em AIRPORTS, 0-%d)\n", NUM_AIRPORTS - 1);
+    printf("  --rate=R       taxa de chegada em aviões por minuto\n");
+    printf("  --p99=T        p99 máximo de espera por recurso em segundos\n");
+    printf("  --crashes=C    quedas toleradas por execução\n");
+    printf("  --explore      explora escalonamentos em busca de deadlocks e starvation\n");
+    printf("  --strategy     escolha do próximo avião a cada decisão\n");
+    printf("  --schedules=K  escalonamentos por quantidade de aviões\n");
+    printf("  --planes=N     explora apenas N aviões\n");
+    printf("  --depth=D      pontos de troca de prioridade (pct) ou decisões exploradas (dfs)\n");
+    printf("  --seed=S       primeira semente, ou a semente reproduzida com --replay\n");
+    printf("  --replay       reproduz um escalonamento com o trace completo\n");
+}
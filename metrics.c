@@ -0,0 +1,355 @@
+// metrics.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "config.h"
+#include "lifecycle.h"
+#include "metrics.h"
+
+Metrics metrics;
+
+// upper bounds of the wait histogram buckets, in seconds
+static const double WAIT_BUCKETS[METRICS_BUCKETS] = { 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 90 };
+
+static const char *STATE_LABELS[N_PLANE_STATES] = {
+    [WAITING_FOR_LANDING]   = "waiting_for_landing",
+    [DURING_LANDING]        = "during_landing",
+    [WAITING_FOR_GATE]      = "waiting_for_gate",
+    [DURING_DISEMBARK]      = "during_disembark",
+    [WAITING_FOR_TAKEOFF]   = "waiting_for_takeoff",
+    [DURING_TAKEOFF]        = "during_takeoff",
+    [FINISHED]              = "finished",
+    [CRASHED_STARVATION]    = "crashed_starvation",
+    [CRASHED_DEADLOCK]      = "crashed_deadlock",
+    [WAITING_FOR_TAXIWAY]   = "waiting_for_taxiway",
+    [DURING_TAXI]           = "during_taxi",
+    [WAITING_FOR_FUEL]      = "waiting_for_fuel",
+    [DURING_REFUEL]         = "during_refuel",
+    [HOLDING]               = "holding",
+    [DIVERTED]              = "diverted",
+};
+
+static const char *RESOURCE_LABELS[N_RESOURCE_TYPES] = {
+    [RESOURCE_TRACK]        = "track",
+    [RESOURCE_GATE]         = "gate",
+    [RESOURCE_TOWER]        = "tower",
+    [RESOURCE_TAXIWAY]      = "taxiway",
+    [RESOURCE_FUEL_TRUCK]   = "fuel_truck",
+};
+
+static const char *FLIGHT_TYPE_LABELS[N_FLIGHT_TYPES] = {
+    [DOMESTIC]              = "domestic",
+    [INTERNATIONAL]         = "international",
+};
+
+// server state
+static pthread_t    server_thread;
+static int          server_fd = -1;
+static bool         server_running = false;
+static int          server_stop = 0;
+static time_t       server_start;
+
+void
+metrics_observe_wait(int phase, double seconds)
+{
+    int bucket = 0;
+    while (bucket < METRICS_BUCKETS && seconds > WAIT_BUCKETS[bucket]) {
+        bucket++;
+    }
+    metrics_add(&metrics.wait_buckets[phase][bucket], 1);
+    metrics_add(&metrics.wait_sum_usec[phase], (int64_t)(seconds * 1e6));
+}
+
+static int64_t
+load(const int64_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+// text buffer for one scrape
+typedef struct {
+    char   *data;
+    size_t  length;
+    size_t  capacity;
+} Page;
+
+static void
+page_printf(Page *page, const char *format, ...)
+{
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(page->data + page->length, page->capacity - page->length, format, args);
+        va_end(args);
+        if (written < 0) return;
+        if (page->length + written < page->capacity) {
+            page->length += written;
+            return;
+        }
+        size_t capacity = page->capacity * 2 + written;
+        char *grown = realloc(page->data, capacity);
+        if (grown == NULL) return;
+        page->data = grown;
+        page->capacity = capacity;
+    }
+}
+
+// prometheus text exposition format, version 0.0.4
+static void
+render(Page *page)
+{
+    page_printf(page, "# HELP margolis_uptime_seconds Seconds since the simulation started.\n");
+    page_printf(page, "# TYPE margolis_uptime_seconds gauge\n");
+    page_printf(page, "margolis_uptime_seconds %ld\n", (long)(time(NULL) - server_start));
+
+    page_printf(page, "# HELP margolis_planes Planes currently in each state.\n");
+    page_printf(page, "# TYPE margolis_planes gauge\n");
+    for (int s = 0; s < N_PLANE_STATES; s++) {
+        page_printf(page, "margolis_planes{state=\"%s\"} %lld\n", STATE_LABELS[s],
+                    (long long)load(&metrics.planes_by_state[s]));
+    }
+
+    page_printf(page, "# HELP margolis_planes_created_total Planes created by the generator.\n");
+    page_printf(page, "# TYPE margolis_planes_created_total counter\n");
+    page_printf(page, "margolis_planes_created_total %lld\n", (long long)load(&metrics.planes_created));
+
+    page_printf(page, "# HELP margolis_planes_finished_total Planes that went through every phase.\n");
+    page_printf(page, "# TYPE margolis_planes_finished_total counter\n");
+    page_printf(page, "margolis_planes_finished_total %lld\n", (long long)load(&metrics.planes_finished));
+
+    page_printf(page, "# HELP margolis_planes_crashed_total Planes crashed, by cause.\n");
+    page_printf(page, "# TYPE margolis_planes_crashed_total counter\n");
+    page_printf(page, "margolis_planes_crashed_total{cause=\"starvation\"} %lld\n",
+                (long long)load(&metrics.planes_crashed_by_starvation));
+    page_printf(page, "margolis_planes_crashed_total{cause=\"deadlock\"} %lld\n",
+                (long long)load(&metrics.planes_crashed_by_deadlock));
+
+    page_printf(page, "# HELP margolis_planes_diverted_total Planes diverted by admission control.\n");
+    page_printf(page, "# TYPE margolis_planes_diverted_total counter\n");
+    page_printf(page, "margolis_planes_diverted_total %lld\n", (long long)load(&metrics.planes_diverted));
+
+    page_printf(page, "# HELP margolis_resource_in_use Units of each resource currently held.\n");
+    page_printf(page, "# TYPE margolis_resource_in_use gauge\n");
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        page_printf(page, "margolis_resource_in_use{resource=\"%s\"} %lld\n", RESOURCE_LABELS[r],
+                    (long long)load(&metrics.resources_in_use[r]));
+    }
+    page_printf(page, "# HELP margolis_resource_capacity Units of each resource.\n");
+    page_printf(page, "# TYPE margolis_resource_capacity gauge\n");
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        page_printf(page, "margolis_resource_capacity{resource=\"%s\"} %lld\n", RESOURCE_LABELS[r],
+                    (long long)load(&metrics.resources_capacity[r]));
+    }
+
+    page_printf(page, "# HELP margolis_waiting_planes Planes waiting for phase resources, by flight type.\n");
+    page_printf(page, "# TYPE margolis_waiting_planes gauge\n");
+    for (int t = 0; t < N_FLIGHT_TYPES; t++) {
+        page_printf(page, "margolis_waiting_planes{flight_type=\"%s\"} %lld\n", FLIGHT_TYPE_LABELS[t],
+                    (long long)load(&metrics.waiting_by_type[t]));
+    }
+    page_printf(page, "# HELP margolis_holding_planes Planes in the holding pattern.\n");
+    page_printf(page, "# TYPE margolis_holding_planes gauge\n");
+    page_printf(page, "margolis_holding_planes %lld\n", (long long)load(&metrics.holding));
+
+    page_printf(page, "# HELP margolis_phase_wait_seconds Time from requesting to holding every resource of a phase.\n");
+    page_printf(page, "# TYPE margolis_phase_wait_seconds histogram\n");
+    int capacity[N_RESOURCE_TYPES];
+    for (int r = 0; r < N_RESOURCE_TYPES; r++) {
+        capacity[r] = (int)load(&metrics.resources_capacity[r]);
+    }
+    for (size_t p = 0; p < METRICS_PHASES; p++) {
+        if (PHASES[p].classes[DOMESTIC].n_resources + PHASES[p].classes[INTERNATIONAL].n_resources == 0) continue;
+        if (!phase_enabled(&PHASES[p], capacity)) continue;
+        int64_t cumulative = 0;
+        for (int b = 0; b <= METRICS_BUCKETS; b++) {
+            cumulative += load(&metrics.wait_buckets[p][b]);
+            if (b < METRICS_BUCKETS) {
+                page_printf(page, "margolis_phase_wait_seconds_bucket{phase=\"%s\",le=\"%g\"} %lld\n",
+                            PHASES[p].action, WAIT_BUCKETS[b], (long long)cumulative);
+            } else {
+                page_printf(page, "margolis_phase_wait_seconds_bucket{phase=\"%s\",le=\"+Inf\"} %lld\n",
+                            PHASES[p].action, (long long)cumulative);
+            }
+        }
+        page_printf(page, "margolis_phase_wait_seconds_sum{phase=\"%s\"} %.6f\n",
+                    PHASES[p].action, load(&metrics.wait_sum_usec[p]) / 1e6);
+        page_printf(page, "margolis_phase_wait_seconds_count{phase=\"%s\"} %lld\n",
+                    PHASES[p].action, (long long)cumulative);
+    }
+}
+
+// answers one scrape; any request gets the metrics page over http/1.0
+static void
+serve(int client)
+{
+    char request[1024];
+    struct timeval timeout = { 0, 100000 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (recv(client, request, sizeof(request), 0) < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        return;
+    }
+
+    Page page = { malloc(16384), 0, 16384 };
+    if (page.data == NULL) return;
+    render(&page);
+
+    char header[160];
+    int header_length = snprintf(header, sizeof(header),
+                                 "HTTP/1.0 200 OK\r\n"
+                                 "Content-Type: text/plain; version=0.0.4\r\n"
+                                 "Content-Length: %zu\r\n\r\n", page.length);
+    if (send(client, header, header_length, MSG_NOSIGNAL) == header_length) {
+        size_t sent = 0;
+        while (sent < page.length) {
+            ssize_t n = send(client, page.data + sent, page.length - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += n;
+        }
+    }
+    free(page.data);
+}
+
+static void*
+metrics_server(void* arg)
+{
+    (void)arg;
+    struct pollfd listener = { server_fd, POLLIN, 0 };
+
+    while (!__atomic_load_n(&server_stop, __ATOMIC_RELAXED)) {
+        // wake up every 200ms to notice metrics_stop()
+        if (poll(&listener, 1, 200) <= 0) continue;
+
+        int client = accept(server_fd, NULL, NULL);
+        if (client < 0) continue;
+        serve(client);
+        close(client);
+    }
+    return NULL;
+}
+
+/*
+ * a socket left by a run that died refuses connections and can be replaced; a live
+ * server, or anything at the path that is not a socket, is left alone
+ */
+static int
+remove_stale_socket(const struct sockaddr_un *address)
+{
+    struct stat status;
+    if (lstat(address->sun_path, &status) != 0) return (errno == ENOENT) ? 0 : -1;
+    if (!S_ISSOCK(status.st_mode)) {
+        errno = EADDRINUSE;
+        return -1;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) return -1;
+    int connected = connect(probe, (const struct sockaddr*)address, sizeof(*address));
+    int error = errno;
+    close(probe);
+
+    if (connected == 0) {
+        errno = EADDRINUSE;
+        return -1;
+    }
+    if (error != ECONNREFUSED) {
+        errno = error;
+        return -1;
+    }
+    return unlink(address->sun_path);
+}
+
+static int
+open_listener(void)
+{
+    if (METRICS_PORT > 0) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(METRICS_PORT);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 8) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, METRICS_SOCKET_PATH, sizeof(address.sun_path) - 1);
+    if (remove_stale_socket(&address) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 8) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int
+metrics_start(time_t simulation_start)
+{
+    server_start = simulation_start;
+    server_fd = open_listener();
+    if (server_fd < 0) {
+        perror("--> falha ao abrir o servidor de métricas");
+        return -1;
+    }
+    if (pthread_create(&server_thread, NULL, metrics_server, NULL) != 0) {
+        perror("--> falha ao criar thread de métricas");
+        close(server_fd);
+        server_fd = -1;
+        return -1;
+    }
+    server_running = true;
+
+    if (METRICS_PORT > 0) {
+        printf("  métricas: http://127.0.0.1:%d/metrics\n", METRICS_PORT);
+    } else {
+        printf("  métricas: %s (curl --unix-socket %s http://localhost/metrics)\n",
+               METRICS_SOCKET_PATH, METRICS_SOCKET_PATH);
+    }
+    return 0;
+}
+
+void
+metrics_stop(void)
+{
+    if (!server_running) return;
+
+    __atomic_store_n(&server_stop, 1, __ATOMIC_RELAXED);
+    pthread_join(server_thread, NULL);
+    close(server_fd);
+    if (METRICS_PORT <= 0) {
+        unlink(METRICS_SOCKET_PATH);
+    }
+    server_running = false;
+}
@@ -0,0 +1,54 @@
+// metrics.h
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include "lifecycle.h"
+
+#define METRICS_PHASES      (sizeof(PHASES) / sizeof(PHASES[0]))
+#define METRICS_BUCKETS     10      // wait histogram buckets, plus +Inf
+
+/*
+ * counters written by plane threads with relaxed atomics and read the same way by
+ * the metrics server, so a scrape never takes a lock a plane could be waiting on.
+ * gauges can be off by one transition while a plane is between two updates.
+ */
+typedef struct {
+    int64_t planes_by_state[N_PLANE_STATES];
+    int64_t planes_created;
+    int64_t planes_finished;
+    int64_t planes_crashed_by_starvation;
+    int64_t planes_crashed_by_deadlock;
+    int64_t planes_diverted;
+    int64_t resources_in_use[N_RESOURCE_TYPES];
+    int64_t resources_capacity[N_RESOURCE_TYPES];
+    int64_t waiting_by_type[N_FLIGHT_TYPES];
+    int64_t holding;
+    int64_t wait_buckets[METRICS_PHASES][METRICS_BUCKETS + 1];
+    int64_t wait_sum_usec[METRICS_PHASES];
+} Metrics;
+
+extern Metrics metrics;
+
+static inline void
+metrics_add(int64_t *counter, int64_t delta)
+{
+    __atomic_fetch_add(counter, delta, __ATOMIC_RELAXED);
+}
+
+static inline void
+metrics_set(int64_t *gauge, int64_t value)
+{
+    __atomic_store_n(gauge, value, __ATOMIC_RELAXED);
+}
+
+// records how long a plane waited for the resources of a phase
+void metrics_observe_wait(int phase, double seconds);
+
+// starts the server thread on METRICS_SOCKET_PATH or METRICS_PORT; 0 on success
+int metrics_start(time_t simulation_start);
+void metrics_stop(void);
+
+#endif /* METRICS_H */
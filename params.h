@@ -58,4 +58,17 @@ static const AirportParameters AIRPORTS[] = {
 
 static const int NUM_AIRPORTS = sizeof(AIRPORTS) / sizeof(AIRPORTS[0]);
 
+// what happens to an arrival when the holding pattern is full
+typedef enum {
+    DIVERT_ARRIVAL      = 0,    // the arriving plane goes to its alternate airport
+    DIVERT_MOST_FUEL    = 1     // the plane with the most fuel left goes, arriving or holding
+} HoldingPolicy;
+
+// how the schedule explorer picks the next plane at each decision point
+typedef enum {
+    EXPLORE_PCT         = 0,    // random plane priorities with a few priority change points
+    EXPLORE_RANDOM      = 1,    // uniformly random runnable plane
+    EXPLORE_DFS         = 2     // every choice of the first EXPLORE_DEPTH decisions, in order
+} ExploreStrategy;
+
 #endif /* PARAMS_H */
@@ -0,0 +1,278 @@
+// perf.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "config.h"
+#include "lifecycle.h"
+#include "perf.h"
+
+/*
+ * hardware and software counters from perf_event_open(2). every thread opens its
+ * own counters the first time it samples, counting only itself, and the deltas
+ * are summed per section with relaxed atomics. counters the kernel refuses, for
+ * lack of a PMU in a VM or a strict perf_event_paranoid, are left out.
+ */
+
+typedef struct {
+    const char *name;
+    const char *label;      // report column
+    uint32_t    type;
+    uint64_t    config;
+} CounterInfo;
+
+static const CounterInfo COUNTERS[N_PERF_COUNTERS] = {
+    [PERF_CYCLES]           = { "cycles",           "ciclos",       PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERF_INSTRUCTIONS]     = { "instructions",     "instruções",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERF_CACHE_MISSES]     = { "cache_misses",     "cache misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    [PERF_CONTEXT_SWITCHES] = { "context_switches", "trocas ctx",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    [PERF_PAGE_FAULTS]      = { "page_faults",      "page faults",  PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+};
+
+static bool     available[N_PERF_COUNTERS];
+static bool     user_only[N_PERF_COUNTERS];     // the kernel only allowed user space counting
+static int      n_available = 0;
+static uint64_t totals[PERF_SECTIONS][N_PERF_COUNTERS];
+static uint64_t samples[PERF_SECTIONS];
+
+static __thread bool    thread_opened = false;
+static __thread int     thread_fds[N_PERF_COUNTERS];
+
+static int
+open_counter(PerfCounter counter, bool exclude_kernel)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = COUNTERS[counter].type;
+    attr.config = COUNTERS[counter].config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = exclude_kernel;
+    attr.exclude_hv = 1;
+
+    // this thread, any cpu
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// the counter scaled up for the time it was multiplexed out
+static uint64_t
+read_counter(int fd)
+{
+    uint64_t data[3];   // value, time enabled, time running
+    if (read(fd, data, sizeof(data)) != sizeof(data)) return 0;
+    if (data[2] == 0 || data[2] >= data[1]) return data[0];
+    return (uint64_t)((double)data[0] * data[1] / data[2]);
+}
+
+int
+perf_open(void)
+{
+    int error = 0;
+    n_available = 0;
+    for (int c = 0; c < N_PERF_COUNTERS; c++) {
+        int fd = open_counter(c, false);
+        if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+            fd = open_counter(c, true);
+            user_only[c] = (fd >= 0);
+        }
+        if (fd < 0) {
+            error = errno;
+            available[c] = false;
+            continue;
+        }
+        close(fd);
+        available[c] = true;
+        n_available++;
+    }
+
+    if (n_available == 0) {
+        printf("contadores de desempenho indisponíveis: %s\n\n", strerror(error));
+    } else if (n_available < N_PERF_COUNTERS) {
+        printf("contadores de desempenho indisponíveis:");
+        for (int c = 0; c < N_PERF_COUNTERS; c++) {
+            if (!available[c]) printf(" %s", COUNTERS[c].name);
+        }
+        printf(" (%s)\n\n", strerror(error));
+    }
+    return n_available;
+}
+
+static bool
+open_thread_counters(void)
+{
+    if (!thread_opened) {
+        for (int c = 0; c < N_PERF_COUNTERS; c++) {
+            thread_fds[c] = available[c] ? open_counter(c, user_only[c]) : -1;
+        }
+        thread_opened = true;
+    }
+    for (int c = 0; c < N_PERF_COUNTERS; c++) {
+        if (thread_fds[c] >= 0) return true;
+    }
+    return false;
+}
+
+void
+perf_begin(PerfSample *sample)
+{
+    sample->valid = (n_available > 0 && open_thread_counters());
+    if (!sample->valid) return;
+
+    for (int c = 0; c < N_PERF_COUNTERS; c++) {
+        sample->values[c] = (thread_fds[c] >= 0) ? read_counter(thread_fds[c]) : 0;
+    }
+}
+
+void
+perf_end(int section, const PerfSample *sample)
+{
+    if (!sample->valid) return;
+
+    for (int c = 0; c < N_PERF_COUNTERS; c++) {
+        if (thread_fds[c] < 0) continue;
+        uint64_t now = read_counter(thread_fds[c]);
+        if (now > sample->values[c]) {
+            __atomic_fetch_add(&totals[section][c], now - sample->values[c], __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_fetch_add(&samples[section], 1, __ATOMIC_RELAXED);
+}
+
+void
+perf_thread_exit(void)
+{
+    if (!thread_opened) return;
+    for (int c = 0; c < N_PERF_COUNTERS; c++) {
+        if (thread_fds[c] >= 0) close(thread_fds[c]);
+        thread_fds[c] = -1;
+    }
+    thread_opened = false;
+}
+
+static const char*
+section_name(int section)
+{
+    if (section == PERF_SPAWN) return "geracao";
+    if (section == (int)PERF_REPORTING) return "relatorio";
+    return PHASES[section - PERF_PHASE(0)].action;
+}
+
+static uint64_t
+load(const uint64_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+// printf widths count bytes, labels have accents
+static void
+print_column(const char *text, int width, bool left)
+{
+    int length = 0;
+    for (const char *c = text; *c; c++) {
+        if ((*c & 0xC0) != 0x80) length++;
+    }
+    if (left) printf("%s%*s", text, width - length, "");
+    else printf("%*s%s", width - length, "", text);
+}
+
+void
+perf_print_report(int planes_finished)
+{
+    if (n_available == 0) return;
+
+    uint64_t total[N_PERF_COUNTERS] = {0};
+    printf("\n--> CONTADORES DE DESEMPENHO:\n");
+    printf("  ");
+    print_column("seção", 14, true);
+    printf(" %8s", "amostras");
+    for (int c = 0; c < N_PERF_COUNTERS; c++) {
+        if (!available[c]) continue;
+        printf(" ");
+        print_column(COUNTERS[c].label, 14, false);
+    }
+    if (available[PERF_CYCLES] && available[PERF_INSTRUCTIONS]) printf(" %6s", "IPC");
+    printf("\n");
+
+    for (int s = 0; s < (int)PERF_SECTIONS; s++) {
+        uint64_t n = load(&samples[s]);
+        if (n == 0) continue;
+
+        printf("  %-14s %8llu", section_name(s), (unsigned long long)n);
+        for (int c = 0; c < N_PERF_COUNTERS; c++) {
+            if (!available[c]) continue;
+            total[c] += load(&totals[s][c]);
+            printf(" %14llu", (unsigned long long)load(&totals[s][c]));
+        }
+        if (available[PERF_CYCLES] && available[PERF_INSTRUCTIONS]) {
+            uint64_t cycles = load(&totals[s][PERF_CYCLES]);
+            printf(" %6.2f", cycles ? (double)load(&totals[s][PERF_INSTRUCTIONS]) / cycles : 0.0);
+        }
+        printf("\n");
+    }
+
+    if (planes_finished > 0) {
+        const char *separator = "";
+        printf("  por avião finalizado:");
+        for (int c = 0; c < N_PERF_COUNTERS; c++) {
+            if (!available[c]) continue;
+            printf("%s %s %.1f", separator, COUNTERS[c].label, (double)total[c] / planes_finished);
+            separator = ",";
+        }
+        printf("\n");
+    }
+}
+
+int
+perf_write(const char *path, int planes_finished)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "--> falha ao escrever %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    uint64_t total[N_PERF_COUNTERS] = {0};
+    fprintf(file, "# section counter value\n");
+    fprintf(file, "total planes_finished %d\n", planes_finished);
+    if (n_available == 0) {
+        // still replace the last run's numbers
+        fprintf(file, "total counters_unavailable 1\n");
+        fclose(file);
+        return 0;
+    }
+    for (int s = 0; s < (int)PERF_SECTIONS; s++) {
+        uint64_t n = load(&samples[s]);
+        if (n == 0) continue;
+
+        fprintf(file, "%s samples %llu\n", section_name(s), (unsigned long long)n);
+        for (int c = 0; c < N_PERF_COUNTERS; c++) {
+            if (!available[c]) continue;
+            total[c] += load(&totals[s][c]);
+            fprintf(file, "%s %s %llu\n", section_name(s), COUNTERS[c].name, (unsigned long long)load(&totals[s][c]));
+        }
+        if (available[PERF_CYCLES] && available[PERF_INSTRUCTIONS] && load(&totals[s][PERF_CYCLES]) > 0) {
+            fprintf(file, "%s ipc %.4f\n", section_name(s),
+                    (double)load(&totals[s][PERF_INSTRUCTIONS]) / load(&totals[s][PERF_CYCLES]));
+        }
+    }
+
+    for (int c = 0; c < N_PERF_COUNTERS; c++) {
+        if (!available[c]) continue;
+        fprintf(file, "total %s %llu\n", COUNTERS[c].name, (unsigned long long)total[c]);
+        if (planes_finished > 0) {
+            fprintf(file, "total %s_per_plane %.4f\n", COUNTERS[c].name, (double)total[c] / planes_finished);
+        }
+    }
+    if (available[PERF_CYCLES] && available[PERF_INSTRUCTIONS] && total[PERF_CYCLES] > 0) {
+        fprintf(file, "total ipc %.4f\n", (double)total[PERF_INSTRUCTIONS] / total[PERF_CYCLES]);
+    }
+
+    fclose(file);
+    return 0;
+}
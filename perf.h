@@ -0,0 +1,43 @@
+// perf.h
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lifecycle.h"
+
+// sections counters are broken down by: plane generation, each lifecycle phase, the final report
+#define PERF_SPAWN          0
+#define PERF_PHASE(p)       (1 + (p))
+#define PERF_REPORTING      (1 + sizeof(PHASES) / sizeof(PHASES[0]))
+#define PERF_SECTIONS       (PERF_REPORTING + 1)
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_CONTEXT_SWITCHES,
+    PERF_PAGE_FAULTS,
+    N_PERF_COUNTERS
+} PerfCounter;
+
+typedef struct {
+    uint64_t    values[N_PERF_COUNTERS];
+    bool        valid;
+} PerfSample;
+
+// probes which counters the kernel lets us open; returns how many, 0 disables sampling
+int perf_open(void);
+
+// counts the calling thread between perf_begin() and perf_end() into a section
+void perf_begin(PerfSample *sample);
+void perf_end(int section, const PerfSample *sample);
+// closes the counters of the calling thread, before it exits
+void perf_thread_exit(void);
+
+void perf_print_report(int planes_finished);
+// one "<section> <counter> <value>" line per figure, for benchmark runs; 0 on success
+int perf_write(const char *path, int planes_finished);
+
+#endif /* PERF_H */
@@ -0,0 +1,187 @@
+// replay.c
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "config.h"
+#include "lifecycle.h"
+#include "sequencer.h"
+#include "replay.h"
+
+/*
+ * recorded runway and gate demand served again in virtual time. the sequencer
+ * replays its trace under FCFS and under pick_use(), the calendar replays its own
+ * with and without the bookings, so each report compares two policies on the
+ * same traffic with the same rules for everything else.
+ *
+ * with bookings, a unit is not given to a use while another plane that has not
+ * been served holds a live booking for it over the use. a booking counts from
+ * the moment it was made and lapses RESERVATION_TOLERANCE after its start, as
+ * in the calendar.
+ */
+
+/*
+ * only uses filed within SEQUENCER_WINDOW of the oldest one compete, so nothing is
+ * overtaken by traffic that arrived more than a window after it. among those, the
+ * shortest separation after 'last' goes first, then international flights, then
+ * the oldest.
+ */
+int
+pick_use(Use *const *uses, int n, RunwayOperation last, bool sequenced)
+{
+    int oldest = 0;
+    for (int i = 1; i < n; i++) {
+        if (uses[i]->requested_at < uses[oldest]->requested_at) oldest = i;
+    }
+    if (!sequenced) return oldest;
+
+    int best = oldest;
+    double horizon = uses[oldest]->requested_at + SEQUENCER_WINDOW;
+    for (int i = 0; i < n; i++) {
+        const Use *candidate = uses[i], *chosen = uses[best];
+        if (candidate->requested_at > horizon) continue;
+
+        double separation = runway_separation(last, candidate->operation);
+        double chosen_separation = runway_separation(last, chosen->operation);
+        if (separation != chosen_separation) {
+            if (separation < chosen_separation) best = i;
+            continue;
+        }
+        if (SEQUENCER_CLASS_PRIORITY && candidate->type != chosen->type) {
+            if (candidate->type == INTERNATIONAL) best = i;
+            continue;
+        }
+        if (candidate->requested_at < chosen->requested_at) best = i;
+    }
+    return best;
+}
+
+Throughput
+measure_uses(const Use *uses, int n)
+{
+    Throughput result = {0};
+    if (n == 0) return result;
+
+    double first = uses[0].requested_at, last = 0, wait = 0;
+    for (int i = 0; i < n; i++) {
+        if (uses[i].requested_at < first) first = uses[i].requested_at;
+        if (uses[i].start_at + uses[i].duration > last) last = uses[i].start_at + uses[i].duration;
+        wait += uses[i].start_at - uses[i].requested_at;
+    }
+    if (last > first) result.operations_per_hour = n / (last - first) * 3600;
+    result.average_wait = wait / n;
+    return result;
+}
+
+static int
+by_request_time(const void *a, const void *b)
+{
+    double x = ((const Use*)a)->requested_at, y = ((const Use*)b)->requested_at;
+    return (x > y) - (x < y);
+}
+
+// true if one of the 'n' live bookings belongs to another plane and overlaps the use from 't'
+static bool
+blocked(const Use *const *bookings, int n, const Use *use, double t)
+{
+    for (int i = 0; i < n; i++) {
+        if (bookings[i]->plane_id == use->plane_id) continue;
+        if (bookings[i]->booked_from < t + use->duration && t < bookings[i]->booked_until) return true;
+    }
+    return false;
+}
+
+Throughput
+replay_uses(Use *uses, int n, int n_units, bool separated, bool sequenced, bool booked)
+{
+    double *released = malloc(n_units * sizeof(double));
+    RunwayOperation *last = malloc(n_units * sizeof(RunwayOperation));
+    bool *tried = malloc(n_units * sizeof(bool));
+    bool *served = calloc(n > 0 ? n : 1, sizeof(bool));
+    Use **queue = malloc((n > 0 ? n : 1) * sizeof(Use*));
+    Use **candidates = malloc((n > 0 ? n : 1) * sizeof(Use*));
+    const Use **live = malloc((n > 0 ? n : 1) * sizeof(Use*));
+    int next = 0, queued = 0, done = 0;
+
+    for (int u = 0; u < n_units; u++) {
+        released[u] = -1e9;
+        last[u] = RUNWAY_NONE;
+    }
+    qsort(uses, n, sizeof(Use), by_request_time);
+    double t = (n > 0) ? uses[0].requested_at : 0;
+
+    while (done < n) {
+        while (next < n && uses[next].requested_at <= t) queue[queued++] = &uses[next++];
+
+        // hand the idle unit released first to someone it may serve
+        Use *use = NULL;
+        int unit = -1;
+        for (int u = 0; u < n_units; u++) tried[u] = false;
+        while (use == NULL && queued > 0) {
+            unit = -1;
+            for (int u = 0; u < n_units; u++) {
+                if (released[u] > t || tried[u]) continue;
+                if (unit < 0 || released[u] < released[unit]) unit = u;
+            }
+            if (unit < 0) break;
+            tried[unit] = true;
+
+            int n_live = 0, n_candidates = 0;
+            for (int i = 0; booked && i < n; i++) {
+                if (!served[i] && uses[i].booked_unit == unit && t >= uses[i].booked_at &&
+                    t <= uses[i].booked_from + RESERVATION_TOLERANCE) live[n_live++] = &uses[i];
+            }
+            for (int i = 0; i < queued; i++) {
+                if (!blocked(live, n_live, queue[i], t)) candidates[n_candidates++] = queue[i];
+            }
+            if (n_candidates > 0) use = candidates[pick_use(candidates, n_candidates, last[unit], sequenced)];
+        }
+
+        if (use == NULL) {
+            // nothing can start now, move on to the next arrival, release or lapse
+            double later = INFINITY;
+            if (next < n) later = uses[next].requested_at;
+            for (int u = 0; u < n_units; u++) {
+                if (released[u] > t && released[u] < later) later = released[u];
+            }
+            for (int i = 0; booked && i < n; i++) {
+                if (served[i] || uses[i].booked_unit < 0) continue;
+                double lapse = uses[i].booked_from + RESERVATION_TOLERANCE;
+                if (uses[i].booked_at > t && uses[i].booked_at < later) later = uses[i].booked_at;
+                if (lapse > t && lapse < later) later = lapse;
+                if (uses[i].booked_until > t && uses[i].booked_until < later) later = uses[i].booked_until;
+            }
+            if (isinf(later)) break;
+            t = later;
+            continue;
+        }
+
+        for (int i = 0; i < queued; i++) {
+            if (queue[i] == use) {
+                queue[i] = queue[--queued];
+                break;
+            }
+        }
+        // honor the booking when the booked unit is idle too
+        if (booked && use->booked_unit >= 0 && use->booked_unit < n_units && released[use->booked_unit] <= t) {
+            unit = use->booked_unit;
+        }
+
+        double ready = released[unit] + (separated ? runway_separation(last[unit], use->operation) : 0);
+        use->start_at = (ready > t) ? ready : t;
+        use->unit = unit;
+        released[unit] = use->start_at + use->duration;
+        last[unit] = use->operation;
+        served[use - uses] = true;
+        done++;
+    }
+
+    free(live);
+    free(candidates);
+    free(queue);
+    free(served);
+    free(tried);
+    free(last);
+    free(released);
+    return measure_uses(uses, n);
+}
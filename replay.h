@@ -0,0 +1,40 @@
+// replay.h
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+
+#include "lifecycle.h"
+
+// one runway or gate operation, as recorded by the sequencer or the calendar
+typedef struct {
+    int             plane_id;
+    int             phase;
+    FlightType      type;
+    RunwayOperation operation;      // RUNWAY_NONE off the runway
+    double          requested_at;   // seconds since the recording started
+    double          start_at;       // unit reserved from here on, rewritten by replay_uses()
+    double          duration;       // time on the unit, filled in on release
+    int             unit;           // -1 while pending
+    int             booked_unit;    // -1 without a booking
+    double          booked_at;      // when the booking was made
+    double          booked_from;    // booked over [booked_from, booked_until)
+    double          booked_until;
+} Use;
+
+typedef struct {
+    double operations_per_hour;
+    double average_wait;
+} Throughput;
+
+// the use to serve next on a unit whose last operation was 'last'
+int pick_use(Use *const *uses, int n, RunwayOperation last, bool sequenced);
+
+Throughput measure_uses(const Use *uses, int n);
+/*
+ * serves the uses again in virtual time on 'n_units' units, sequenced or FCFS,
+ * with runway separations if 'separated' and keeping off booked units if 'booked'
+ */
+Throughput replay_uses(Use *uses, int n, int n_units, bool separated, bool sequenced, bool booked);
+
+#endif /* REPLAY_H */
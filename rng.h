@@ -0,0 +1,37 @@
+// rng.h
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// xorshift64*, seeded per run: rand() is neither reentrant nor reproducible across threads
+static inline uint64_t
+rng_seed(uint64_t seed)
+{
+    return seed * 0x9E3779B97F4A7C15ULL + 1;
+}
+
+// uniform in [0, 1)
+static inline double
+rng_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (double)((*state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+static inline double
+rng_uniform(uint64_t *state, double min, double max)
+{
+    return min + (max - min) * rng_random(state);
+}
+
+// uniform in [0, n)
+static inline int
+rng_below(uint64_t *state, int n)
+{
+    return (int)(rng_random(state) * n);
+}
+
+#endif /* RNG_H */
@@ -0,0 +1,262 @@
+// sequencer.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "config.h"
+#include "lifecycle.h"
+#include "timing.h"
+#include "sequencer.h"
+#include "calendar.h"
+#include "replay.h"
+
+/*
+ * runway sequencer. a plane that needs a track files a request and blocks; whenever
+ * a runway is idle the sequencer picks the next request for it with pick_use() and
+ * reserves the runway until the separation after its last operation has passed.
+ *
+ * with reservations enabled, a runway is not given to a plane while another one
+ * holds a booking for it over the operation.
+ *
+ * every operation is recorded, and the report replays that demand in virtual time
+ * under FCFS and under pick_use() with the same runways and separations, so the gain
+ * is measured on the traffic the simulation actually produced.
+ */
+
+typedef struct {
+    bool            busy;           // reserved or in use
+    RunwayOperation last_operation;
+    double          last_release;
+    Use             current;
+} Runway;
+
+static const double SEPARATIONS[N_RUNWAY_OPERATIONS][N_RUNWAY_OPERATIONS] = {
+    [RUNWAY_LANDING] = {
+        [RUNWAY_LANDING] = SEPARATION_LANDING_LANDING,
+        [RUNWAY_TAKEOFF] = SEPARATION_LANDING_TAKEOFF,
+    },
+    [RUNWAY_TAKEOFF] = {
+        [RUNWAY_LANDING] = SEPARATION_TAKEOFF_LANDING,
+        [RUNWAY_TAKEOFF] = SEPARATION_TAKEOFF_TAKEOFF,
+    },
+};
+
+double
+runway_separation(RunwayOperation last, RunwayOperation next)
+{
+    return SEPARATIONS[last][next];
+}
+
+void
+runways_reset(Runways *runways, int n)
+{
+    runways->n = n;
+    for (int r = 0; r < n; r++) {
+        runways->busy[r] = false;
+        runways->last[r] = RUNWAY_NONE;
+        runways->released_at[r] = -1e9;
+    }
+}
+
+int
+runways_first_ready(const Runways *runways, RunwayOperation operation, double *ready_at)
+{
+    int first = -1;
+    for (int r = 0; r < runways->n; r++) {
+        if (runways->busy[r]) continue;
+        double ready = runways->released_at[r] + SEPARATIONS[runways->last[r]][operation];
+        if (first < 0 || ready < *ready_at) {
+            first = r;
+            *ready_at = ready;
+        }
+    }
+    return first;
+}
+
+void
+runways_take(Runways *runways, int runway)
+{
+    runways->busy[runway] = true;
+}
+
+void
+runways_release(Runways *runways, int runway, RunwayOperation operation, double now)
+{
+    runways->busy[runway] = false;
+    runways->last[runway] = operation;
+    runways->released_at[runway] = now;
+}
+
+static pthread_mutex_t  mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   assigned = PTHREAD_COND_INITIALIZER;
+static struct timespec  opened_at;
+static Runway          *runways;
+static int              n_runways;
+static Use            **pending;
+static int              n_pending;
+static Use            **candidates;
+static bool            *skipped;
+static Use             *trace;
+static int              trace_length;
+static int              trace_capacity;
+
+// hands idle runways to pending requests, earliest released runway first
+static void
+assign_runways(void)
+{
+    for (int i = 0; i < n_runways; i++) skipped[i] = false;
+
+    while (n_pending > 0) {
+        int r = -1;
+        for (int i = 0; i < n_runways; i++) {
+            if (runways[i].busy || skipped[i]) continue;
+            if (r < 0 || runways[i].last_release < runways[r].last_release) r = i;
+        }
+        if (r < 0) return;
+
+        int n = 0;
+        for (int i = 0; i < n_pending; i++) {
+            if (!RESERVATIONS_ENABLED ||
+                calendar_allows(RESOURCE_TRACK, r, pending[i]->plane_id, PHASES[pending[i]->phase].max_usec / 1e6)) {
+                candidates[n++] = pending[i];
+            }
+        }
+        if (n == 0) {
+            skipped[r] = true;
+            continue;
+        }
+
+        Use *request = candidates[pick_use(candidates, n, runways[r].last_operation, true)];
+        for (int i = 0; i < n_pending; i++) {
+            if (pending[i] == request) {
+                pending[i] = pending[--n_pending];
+                break;
+            }
+        }
+
+        // honor the booking when the booked runway is idle too
+        if (RESERVATIONS_ENABLED) {
+            int booked = calendar_booked(request->plane_id, request->phase, RESOURCE_TRACK);
+            if (booked >= 0 && booked < n_runways && !runways[booked].busy) r = booked;
+        }
+
+        double ready = runways[r].last_release + SEPARATIONS[runways[r].last_operation][request->operation];
+        double t = seconds_since(&opened_at);
+        request->unit = r;
+        request->start_at = (ready > t) ? ready : t;
+        runways[r].busy = true;
+        runways[r].current = *request;
+    }
+}
+
+void
+sequencer_open(int runway_count, int max_operations)
+{
+    clock_gettime(CLOCK_MONOTONIC, &opened_at);
+    n_runways = runway_count;
+    runways = calloc(n_runways, sizeof(Runway));
+    for (int r = 0; r < n_runways; r++) {
+        runways[r].last_operation = RUNWAY_NONE;
+        runways[r].last_release = -1e9;
+    }
+    skipped = calloc(n_runways, sizeof(bool));
+    pending = malloc(max_operations * sizeof(Use*));
+    candidates = malloc(max_operations * sizeof(Use*));
+    n_pending = 0;
+    trace = malloc(max_operations * sizeof(Use));
+    trace_length = 0;
+    trace_capacity = max_operations;
+}
+
+void
+sequencer_close(void)
+{
+    free(runways);
+    free(skipped);
+    free(pending);
+    free(candidates);
+    free(trace);
+}
+
+int
+sequencer_acquire(int plane_id, FlightType type, int phase)
+{
+    Use request = {
+        .plane_id = plane_id, .phase = phase, .type = type, .operation = PHASES[phase].runway,
+        .unit = -1, .booked_unit = -1,
+    };
+
+    pthread_mutex_lock(&mutex);
+    request.requested_at = seconds_since(&opened_at);
+    pending[n_pending++] = &request;
+    assign_runways();
+    while (request.unit < 0) {
+        if (!RESERVATIONS_ENABLED) {
+            pthread_cond_wait(&assigned, &mutex);
+            continue;
+        }
+
+        // a runway held back by someone else's booking frees up when it lapses
+        if (timed_wait_ms(&assigned, &mutex, 100) != 0) assign_runways();
+    }
+    pthread_mutex_unlock(&mutex);
+
+    // the runway is ours, wait out the separation
+    double delay = request.start_at - seconds_since(&opened_at);
+    if (delay > 0) usleep(delay * 1e6);
+    return request.unit;
+}
+
+void
+sequencer_release(int runway)
+{
+    pthread_mutex_lock(&mutex);
+    Runway *r = &runways[runway];
+    double t = seconds_since(&opened_at);
+
+    r->current.duration = t - r->current.start_at;
+    if (trace_length < trace_capacity) trace[trace_length++] = r->current;
+    r->busy = false;
+    r->last_operation = r->current.operation;
+    r->last_release = t;
+
+    assign_runways();
+    pthread_cond_broadcast(&assigned);
+    pthread_mutex_unlock(&mutex);
+}
+
+void
+sequencer_print_report(void)
+{
+    pthread_mutex_lock(&mutex);
+    int n = trace_length;
+    Use *requests = malloc((n > 0 ? n : 1) * sizeof(Use));
+    for (int i = 0; i < n; i++) requests[i] = trace[i];
+    pthread_mutex_unlock(&mutex);
+
+    int landings = 0;
+    for (int i = 0; i < n; i++) landings += (requests[i].operation == RUNWAY_LANDING);
+
+    Throughput measured = measure_uses(requests, n);
+    Throughput fcfs = replay_uses(requests, n, n_runways, true, false, false);
+    Throughput sequenced = replay_uses(requests, n, n_runways, true, true, false);
+
+    printf("\n--> SEQUENCIAMENTO DE PISTA:\n");
+    printf("  operações: %d (pousos: %d, decolagens: %d)\n", n, landings, n - landings);
+    printf("  medido: %.0f operações/h, espera média de %.2fs\n",
+           measured.operations_per_hour, measured.average_wait);
+    printf("  mesma demanda reproduzida:\n");
+    printf("    FCFS:         %.0f operações/h, espera média de %.2fs\n",
+           fcfs.operations_per_hour, fcfs.average_wait);
+    printf("    sequenciador: %.0f operações/h, espera média de %.2fs\n",
+           sequenced.operations_per_hour, sequenced.average_wait);
+    if (fcfs.operations_per_hour > 0) {
+        printf("    ganho sobre FCFS: %+.1f%% operações/h, %+.2fs de espera\n",
+               (sequenced.operations_per_hour / fcfs.operations_per_hour - 1) * 100,
+               sequenced.average_wait - fcfs.average_wait);
+    }
+    free(requests);
+}
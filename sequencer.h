@@ -0,0 +1,40 @@
+// sequencer.h
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <stdbool.h>
+
+#include "lifecycle.h"
+
+#define MAX_RUNWAYS 16
+
+/*
+ * runways as the capacity model and the explorer see them with SEQUENCER_ENABLED:
+ * a track goes to an idle runway, and the operation starts once the separation
+ * after that runway's last operation has passed
+ */
+typedef struct {
+    int             n;
+    bool            busy[MAX_RUNWAYS];
+    RunwayOperation last[MAX_RUNWAYS];
+    double          released_at[MAX_RUNWAYS];
+} Runways;
+
+double runway_separation(RunwayOperation last, RunwayOperation next);
+void runways_reset(Runways *runways, int n);
+// the idle runway that can start 'operation' first and when, -1 if none is idle
+int runways_first_ready(const Runways *runways, RunwayOperation operation, double *ready_at);
+void runways_take(Runways *runways, int runway);
+void runways_release(Runways *runways, int runway, RunwayOperation operation, double now);
+
+void sequencer_open(int n_runways, int max_operations);
+void sequencer_close(void);
+
+// blocks until a runway is assigned and its separation has passed; returns the runway
+int sequencer_acquire(int plane_id, FlightType type, int phase);
+void sequencer_release(int runway);
+
+// measured throughput and the replay of the same demand under FCFS and sequencing
+void sequencer_print_report(void);
+
+#endif /* SEQUENCER_H */
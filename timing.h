@@ -0,0 +1,32 @@
+// timing.h
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <pthread.h>
+#include <time.h>
+
+// seconds on the monotonic clock since 'start'
+static inline double
+seconds_since(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// waits on 'cond' for at most 'ms' milliseconds; 0 if signalled, ETIMEDOUT otherwise
+static inline int
+timed_wait_ms(pthread_cond_t *cond, pthread_mutex_t *mutex, int ms)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    return pthread_cond_timedwait(cond, mutex, &deadline);
+}
+
+#endif /* TIMING_H */